@@ -15,6 +15,9 @@
 
 using namespace std;
 
+#define POLLUTION_FILTER 4096 //entries of the direct-mapped filter of prefetch victims
+#define KERNEL_BATCH 4096     //trace entries decoded at a time for the specialized kernel
+
 cache::cache(unsigned size, 
       unsigned associativity,
       unsigned line_size,
@@ -22,7 +25,8 @@ cache::cache(unsigned size,
       write_policy_t wr_miss_policy,
       unsigned hit_time,
       unsigned miss_penalty,
-      unsigned address_width
+      unsigned address_width,
+      replacement_policy_t replacement_kind
 ){
     //reset Cache
     numRead = 0;
@@ -41,6 +45,64 @@ cache::cache(unsigned size,
     hitTime = hit_time;
     missPenalty = miss_penalty;
     memAddressSize = address_width;
+    replacement = replacement_kind;
+    prefetchPolicy = PREFETCH_NONE;
+    prefetchDegree = 0;
+    pf = NULL;
+    prefetchLatency = 0;
+    numPrefetch = 0;
+    numPrefetchUseful = 0;
+    numPrefetchLate = 0;
+    numPrefetchPolluting = 0;
+    numPrefetchUnused = 0;
+    assistKind = VICTIM_CACHE;
+    numAssistHits = 0;
+    numSectors = 1;
+    numSectorMiss = 0;
+    warmAccesses = 0;
+    profile = NULL;
+    classifier = NULL;
+    tlbs = NULL;
+    vipt = false;
+    pageOffsetBits = 0;
+    translationCycles = 0;
+    profileTop = 0;
+    numMshrs = 0;
+    issueInterval = 1;
+    mshrClock = 0;
+    mshrFinish = 0;
+    mshrCovered = 0;
+    missBusyCycles = 0;
+    missCycles = 0;
+    accessCycles = 0;
+    numPrimaryMiss = 0;
+    numSecondaryMiss = 0;
+    numMshrStall = 0;
+    mshrStallCycles = 0;
+    samplingMode = SAMPLE_NONE;
+    sampleSets = 1;
+    samplePeriod = 0;
+    sampleWarmup = 0;
+    sampleDetail = 0;
+    sampleTotal = 0;
+    sampleEvict = 0;
+    sampleMemWrite = 0;
+    windowEvict = 0;
+    windowMemWrite = 0;
+    windowOpen = false;
+    intervalLength = 0;
+    nextInterval = ~0ULL;
+    bytesFill = 0;
+    bytesWriteback = 0;
+    bytesWriteThrough = 0;
+    showTraffic = false;
+    memoryBandwidth = 0;
+    memoryClock = 0;
+    channelFree = 0;
+    accessStall = 0;
+    stallCycles = 0;
+    writeBytes = WRITE_BYTES;
+    outcome = access_outcome_t();
 
     //Bits
     c_set = c_size/(blockSize*numWays);
@@ -51,18 +113,22 @@ cache::cache(unsigned size,
     //maskBlockOffsetBits = getMemAddrBits(blkoffBits,0);
     maskSetBits = getMemAddrBits(setBits,blkoffBits);
     //maskTagBits = getMemAddrBits(tagBits,(blkoffBits+setBits));
+    sectorSize = blockSize;
+    sectorBits = blkoffBits;
 
-    cacheTable = vector<vector<cache_entries>>(numWays,vector<cache_entries>(c_set));
-
-    for(unsigned i = 0; i < numWays; i++){
-        for(unsigned j = 0; j < blkoffBits; j++){
-            cacheTable[i][j].valid = 0;
-            cacheTable[i][j].dirty = 0;
-            cacheTable[i][j].set = 0;
-            cacheTable[i][j].tag = 0;
-            cacheTable[i][j].LRU = 0;
-        }
+    tagArray.assign(c_set*numWays, 0);
+    stateArray.assign(c_set*numWays, 0);
+    policy = make_replacement_policy(replacement, c_set, numWays);
+    if(policy == NULL){
+        //LRU, or a policy the geometry does not support
+        replacement = REPLACE_LRU;
+        lruArray.assign(c_set*numWays, 0);
     }
+    kernel = select_kernel(numWays, hitPolicy, missPolicy, true);
+}
+
+void cache::set_simd_kernels(bool enable){
+    kernel = select_kernel(numWays, hitPolicy, missPolicy, enable);
 }
 
 void cache::print_configuration(){
@@ -92,10 +158,50 @@ void cache::print_configuration(){
     cout << "cache hit time = " << hitTime << " CLK" <<endl;
     cout << "cache miss penalty = " << missPenalty << " CLK" <<endl;
     cout << "memory address width = " << memAddressSize << " bits" <<endl;
+    if(replacement != REPLACE_LRU){
+        cout << "replacement policy = " << replacement_policy_name(replacement) <<endl;
+    }
+    if(memoryBandwidth > 0){
+        cout << "memory bandwidth = " << memoryBandwidth << " B/CLK" <<endl;
+    }
+    if(numMshrs){
+        cout << "MSHRs = " << numMshrs << " (an access issued every " << issueInterval << " CLK)" <<endl;
+    }
+    if(samplingMode == SAMPLE_SETS){
+        cout << "set sampling = 1 in " << sampleSets << " sets" <<endl;
+    }
+    else if(samplingMode == SAMPLE_INTERVALS){
+        cout << "interval sampling = " << sampleDetail << " measured, " << sampleWarmup
+             << " warmed in every " << samplePeriod << " accesses" <<endl;
+    }
+    if(numSectors > 1){
+        cout << "sectors per line = " << numSectors << " (" << sectorSize << " B)" <<endl;
+    }
+    if(!assistBuffer.empty()){
+        cout << (assistKind == VICTIM_CACHE ? "victim cache = " : "miss cache = ") << assistBuffer.size() << " entries" <<endl;
+    }
+    if(pf){
+        cout << "prefetcher = " << prefetch_policy_name(prefetchPolicy) << " (degree " << prefetchDegree << ")" <<endl;
+    }
+    if(tlbs){
+        cout << "cache indexing = " << (vipt ? "virtually indexed, physically tagged" : "physically indexed, physically tagged") <<endl;
+        if(vipt && blkoffBits + setBits > pageOffsetBits){
+            cout << "index bits above the page offset = " << blkoffBits + setBits - pageOffsetBits << " (synonyms possible)" <<endl;
+        }
+        tlbs->print_configuration();
+    }
 }
 
 cache::~cache(){
-	cacheTable.clear();
+	set_interval_stats(0);
+	tagArray.clear();
+	stateArray.clear();
+	lruArray.clear();
+	delete policy;
+	delete pf;
+	delete profile;
+	delete classifier;
+	delete tlbs;
 	numRead = 0;
 	numReadMiss = 0;
 	numWrite = 0;
@@ -106,137 +212,621 @@ cache::~cache(){
 	number_memory_accesses = 0;
 }
 
-void cache::load_trace(const char *filename){
-   stream.open(filename);
+bool cache::load_trace(const char *filename, trace_format_t format){
+   return trace.open(filename, format);
 }
 
 void cache::run(unsigned num_entries){
-    long long memoryTagBits;
-    long long memorySetBits;
-    long long cacheSetIndex;
-
-    unsigned evictWayIndex;
-    bool isFull = true;
-
-    unsigned first_access = number_memory_accesses;
-    string line;
-    unsigned line_nr=0;
-
-    while (getline(stream,line)){
-        line_nr++;
-        char *str = const_cast<char*>(line.c_str());
-
-        // tokenize the instruction
-        char *op = strtok (str," ");
-        char *addr = strtok (NULL, " ");
-        address_t address = strtoull(addr, NULL, 16);
-
-        if(op[0] == 'r'){
-            numRead++;
-            //cout << "read" << endl;
-            if(read(address)){
-                numReadMiss++;
-                //cout << "read miss" << endl;
-                memoryTagBits = address >> (blkoffBits + setBits);
-                memorySetBits = (address >> blkoffBits) & maskSetBits;
-                cacheSetIndex = memorySetBits % c_set;
-
-                for(unsigned i = 0; i < numWays; i++){
-                    if(!cacheTable[i][cacheSetIndex].valid){
-                        cacheTable[i][cacheSetIndex].valid = 1;
-                        cacheTable[i][cacheSetIndex].set = memorySetBits;
-                        cacheTable[i][cacheSetIndex].tag = memoryTagBits;
-                        cacheTable[i][cacheSetIndex].LRU = number_memory_accesses;
-                        isFull = false;
-                        break;
-                        //cout << "cache added" << endl;
-                    }
-                }
-                if(isFull){
-                    evictWayIndex = evict(cacheSetIndex);
-                    //cout << "cache is full, evict Index: " << evictWayIndex << endl;
-                    if(cacheTable[evictWayIndex][cacheSetIndex].dirty == 1){
-                        cacheTable[evictWayIndex][cacheSetIndex].dirty = 0;
-                        numMemWrite++;
-                    }
-                    cacheTable[evictWayIndex][cacheSetIndex].set = memorySetBits;
-                    cacheTable[evictWayIndex][cacheSetIndex].tag = memoryTagBits;
-                    cacheTable[evictWayIndex][cacheSetIndex].LRU = number_memory_accesses;
-                }
+    if(samplingMode != SAMPLE_NONE){
+        run_sampled(num_entries);
+        return;
+    }
+    unsigned long long first_access = number_memory_accesses;
+    char op;
+    address_t address;
+
+    if(profile){
+        long long pc, tag;
+        while (trace.next(op, address, pc, tag)){
+            step(op, address);
+            if(op == 'r' || op == 'w'){
+                //the victim fields only mean something when a line was replaced
+                if(outcome.evicted) profile->record(pc, tag, address, !outcome.hit, true, outcome.victim, outcome.victimDirty);
+                else profile->record(pc, tag, address, !outcome.hit, false, 0, false);
             }
-            else{
-                //cout << "read hit" << endl;
+            if (num_entries!=0 && (number_memory_accesses-first_access)==num_entries)
+                break;
+        }
+        return;
+    }
+
+    if(plain_lru()){
+        //decode a batch, then let the specialized kernel simulate it
+        char ops[KERNEL_BATCH];
+        long long blocks[KERNEL_BATCH];
+        kernel_counts_t n = kernel_counts(number_memory_accesses);
+        for(;;){
+            unsigned count = 0;
+            unsigned left = num_entries ? num_entries - (n.clock - first_access) : KERNEL_BATCH;
+            while(count < KERNEL_BATCH && count < left && trace.next(ops[count], address)){
+                blocks[count++] = address >> blkoffBits;
             }
+            if(count == 0) break;
+            kernel(*this, ops, blocks, count, n);
+        }
+        merge_kernel_counts(n);
+        return;
+    }
+
+    while (trace.next(op, address)){
+        step(op, address);
+        if (num_entries!=0 && (number_memory_accesses-first_access)==num_entries)
+            break;
+    }
+}
+
+void cache::step(char op, address_t address){
+    long long block = tlbs ? translate(address) : address >> blkoffBits;
+    access_block(op, block, (address >> sectorBits) & (numSectors - 1));
+    if(numMshrs && (op == 'r' || op == 'w')){
+        mshr_access(address >> blkoffBits, !outcome.hit && (op == 'r' || missPolicy == WRITE_ALLOCATE));
+    }
+    if(classifier && (op == 'r' || op == 'w')){
+        classifier->classify(address >> blkoffBits, !outcome.hit, op == 'r' || missPolicy == WRITE_ALLOCATE);
+    }
+    number_memory_accesses++;
+    if(number_memory_accesses == nextInterval) end_interval();
+}
+
+access_result_t cache::access(address_t address, char op, unsigned size){
+    access_result_t result;
+    result.type = HIT;
+    result.latency = 0;
+    if(size == 0) size = 1;
+
+    //split the access at line (or sector) boundaries, in unsigned arithmetic so that an access
+    //running past the top of the address space stops there instead of overflowing
+    unsigned long long first = (unsigned long long)address;
+    unsigned long long last = first + size - 1;
+    if(last < first) last = ~0ULL;
+    unsigned long long pieces = (last >> sectorBits) - (first >> sectorBits) + 1;
+    double stalled = stallCycles;
+    unsigned long long translated = translationCycles;
+    for(unsigned long long i = 0; i < pieces; i++){
+        unsigned long long piece = (first >> sectorBits) + i;
+        unsigned long long start = (piece << sectorBits) > first ? (piece << sectorBits) : first;
+        unsigned long long end = ((piece + 1) << sectorBits) - 1 < last ? ((piece + 1) << sectorBits) - 1 : last;
+        writeBytes = unsigned(end - start + 1);
+        step(op, (address_t)start);
+        result.latency += hitTime;
+        if(!outcome.hit){
+            result.type = MISS;
+            result.latency += missPenalty;
         }
-        else if(op[0] == 'w'){
-            numWrite++;
-            //cout << "write" << endl;
-            if(write(address)){
-                numWriteMiss++;
-                //cout << "write miss" << endl;
-                if(missPolicy == WRITE_ALLOCATE){
-                    memoryTagBits = address >> (blkoffBits + setBits);
-                    memorySetBits = (address >> blkoffBits) & maskSetBits;
-                    cacheSetIndex = memorySetBits % c_set;
-
-                    for(unsigned i = 0; i < numWays; i++){
-                        if(!cacheTable[i][cacheSetIndex].valid){
-                            cacheTable[i][cacheSetIndex].valid = 1;
-                            if(hitPolicy == WRITE_BACK){
-                                cacheTable[i][cacheSetIndex].dirty = 1;
-                            }
-                            else if(hitPolicy == WRITE_THROUGH){
-                                numMemWrite++;
-                            }
-                            cacheTable[i][cacheSetIndex].set = memorySetBits;
-                            cacheTable[i][cacheSetIndex].tag = memoryTagBits;
-                            cacheTable[i][cacheSetIndex].LRU = number_memory_accesses;
-                            isFull = false;
-                            break;
-                            //cout << "cache added" << endl;
-                        }
-                    }
-                    if(isFull){
-                        evictWayIndex = evict(cacheSetIndex);
-                        //cout << "cache is full, evict Index: " << evictWayIndex << endl;
-                        if(cacheTable[evictWayIndex][cacheSetIndex].dirty){
-                            cacheTable[evictWayIndex][cacheSetIndex].dirty = 0;
-                            numMemWrite++;
-                        }
-                        if(hitPolicy == WRITE_BACK){
-                            cacheTable[evictWayIndex][cacheSetIndex].dirty = 1;
-                        }
-                        else if(hitPolicy == WRITE_THROUGH){
-                            numMemWrite++;
-                        }
-                        cacheTable[evictWayIndex][cacheSetIndex].set = memorySetBits;
-                        cacheTable[evictWayIndex][cacheSetIndex].tag = memoryTagBits;
-                        cacheTable[evictWayIndex][cacheSetIndex].LRU = number_memory_accesses;
-                    }
+    }
+    writeBytes = WRITE_BYTES;
+    result.latency += unsigned(stallCycles - stalled) + unsigned(translationCycles - translated);
+    return result;
+}
+
+unsigned cache::access_many(const access_request_t *requests, unsigned count, access_result_t *results){
+    unsigned hits = 0;
+    for(unsigned i = 0; i < count; i++){
+        access_result_t r = access(requests[i].address, requests[i].op, requests[i].size);
+        if(r.type == HIT) hits++;
+        if(results != NULL) results[i] = r;
+    }
+    return hits;
+}
+
+void cache::set_miss_profile(unsigned top, unsigned page_size){
+    delete profile;
+    profile = top ? new miss_profile(page_size) : NULL;
+    profileTop = top;
+}
+
+void cache::set_miss_classification(bool enable){
+    delete classifier;
+    classifier = enable ? new miss_classifier(c_set * numWays) : NULL;
+}
+
+void cache::set_translation(tlb_hierarchy *translation, bool virtually_indexed){
+    if(translation != tlbs) delete tlbs;
+    tlbs = translation;
+    vipt = virtually_indexed && translation != NULL;
+    pageOffsetBits = tlbs ? tlbs->min_page_bits() : 0;
+}
+
+long long cache::translate(address_t &address, bool counted){
+    address_t virt = address;
+    unsigned latency = 0;
+    address = tlbs->translate(virt, latency, counted);
+    if(vipt){
+        unsigned hidden = tlbs->first_hit_time();
+        latency -= (hidden < hitTime ? hidden : hitTime);
+    }
+    if(counted) translationCycles += latency;
+
+    if(!vipt || blkoffBits + setBits <= pageOffsetBits) return address >> blkoffBits;
+    //the set bits above the page offset come from the virtual address, so the tag
+    //keeps every physical bit above the page offset to stay unique within a set
+    return ((address >> pageOffsetBits) << setBits) | ((virt >> blkoffBits) & (c_set - 1));
+}
+
+void cache::set_mshrs(unsigned entries, unsigned issue_interval){
+    numMshrs = entries;
+    issueInterval = issue_interval ? issue_interval : 1;
+    mshrs.clear();
+    mshrs.reserve(entries);
+}
+
+void cache::mshr_access(long long block, bool fetch){
+    unsigned long long issue = mshrClock;
+
+    //retire the misses that have been served
+    for(unsigned i = 0; i < mshrs.size(); ){
+        if(mshrs[i].ready <= issue){
+            mshrs[i] = mshrs.back();
+            mshrs.pop_back();
+        }
+        else i++;
+    }
+
+    unsigned long long done = issue + hitTime;
+    unsigned i = 0;
+    while(i < mshrs.size() && mshrs[i].block != block) i++;
+    if(i < mshrs.size()){
+        //the block is still on its way: wait for it instead of fetching it again
+        numSecondaryMiss++;
+        if(mshrs[i].ready > done) done = mshrs[i].ready;
+    }
+    else if(fetch){
+        if(mshrs.size() == numMshrs){
+            //every MSHR is busy: issue waits for the first one to free up
+            unsigned first = 0;
+            for(unsigned j = 1; j < mshrs.size(); j++) if(mshrs[j].ready < mshrs[first].ready) first = j;
+            numMshrStall++;
+            mshrStallCycles += mshrs[first].ready - issue;
+            issue = mshrs[first].ready;
+            mshrs[first] = mshrs.back();
+            mshrs.pop_back();
+        }
+        numPrimaryMiss++;
+        mshr_entry e = {block, issue + hitTime + missPenalty};
+        mshrs.push_back(e);
+        done = e.ready;
+
+        missCycles += e.ready - issue;
+        unsigned long long start = (issue > mshrCovered) ? issue : mshrCovered;
+        if(e.ready > start) missBusyCycles += e.ready - start;
+        if(e.ready > mshrCovered) mshrCovered = e.ready;
+    }
+
+    accessCycles += done - mshrClock;
+    if(done > mshrFinish) mshrFinish = done;
+    mshrClock = issue + issueInterval;
+}
+
+void cache::replay(const char *ops, const long long *blocks, unsigned count){
+    if(plain_lru()){
+        kernel_counts_t n = kernel_counts(number_memory_accesses);
+        kernel(*this, ops, blocks, count, n);
+        merge_kernel_counts(n);
+        return;
+    }
+    for(unsigned i = 0; i < count; i++){
+        access_block(ops[i], blocks[i]);
+        number_memory_accesses++;
+    }
+}
+
+kernel_counts_t cache::kernel_counts(unsigned long long clock){
+    kernel_counts_t n;
+    memset(&n, 0, sizeof(n));
+    n.clock = clock;
+    return n;
+}
+
+void cache::merge_kernel_counts(const kernel_counts_t &n){
+    numRead += n.reads;
+    numReadMiss += n.readMisses;
+    numWrite += n.writes;
+    numWriteMiss += n.writeMisses;
+    numEvict += n.evictions;
+    numMemWrite += n.memoryWrites;
+    bytesFill += n.fills * blockSize;
+    bytesWriteback += n.writebacks * blockSize;
+    bytesWriteThrough += n.writesThrough * writeBytes;
+    number_memory_accesses = n.clock;
+}
+
+bool cache::plain_lru() const{
+    return !policy && !pf && assistBuffer.empty() && numSectors == 1 && memoryBandwidth <= 0 && !intervalLength &&
+           samplingMode == SAMPLE_NONE && !numMshrs && !profile && !classifier && !tlbs;
+}
+
+void cache::access_block(char op, long long block, unsigned sector){
+    long long memoryTagBits = block >> setBits;
+    long long cacheSetIndex = (block & maskSetBits) % c_set;
+    unsigned base = setBase(cacheSetIndex);
+    unsigned line = findLine(base, memoryTagBits);
+
+    outcome = access_outcome_t();
+    if(line == NO_LINE && !assistBuffer.empty() && (op == 'r' || op == 'w')){
+        line = assist_hit(cacheSetIndex, block);
+    }
+    //a sectored line can be present without the sector being accessed
+    bool sectorMiss = (numSectors > 1 && line != NO_LINE && !((sectorValid[line] >> sector) & 1));
+    outcome.hit = (line != NO_LINE && !sectorMiss);
+
+    bool prefetchHit = false;
+    if(outcome.hit && (stateArray[line] & LINE_PREFETCHED)){
+        prefetchHit = true;
+        stateArray[line] &= ~LINE_PREFETCHED;
+        numPrefetchUseful++;
+        if(number_memory_accesses < readyArray[line]) numPrefetchLate++;
+    }
+
+    if(op == 'r'){
+        numRead++;
+        if(outcome.hit){
+            touch(cacheSetIndex, line);
+        }
+        else{
+            numReadMiss++;
+            fetch(cacheSetIndex, memoryTagBits, line, sector);
+        }
+    }
+    else if(op == 'w'){
+        numWrite++;
+        if(outcome.hit){
+            if(hitPolicy == WRITE_BACK) mark_dirty(line, sector);
+            touch(cacheSetIndex, line);
+            if(hitPolicy == WRITE_THROUGH){
+                numMemWrite++;
+                transfer(bytesWriteThrough, writeBytes);
+            }
+        }
+        else{
+            numWriteMiss++;
+            if(missPolicy == WRITE_ALLOCATE){
+                line = fetch(cacheSetIndex, memoryTagBits, line, sector);
+                if(hitPolicy == WRITE_BACK){
+                    mark_dirty(line, sector);
                 }
-                else if(missPolicy == NO_WRITE_ALLOCATE){
-                    if(hitPolicy == WRITE_THROUGH) numMemWrite++;
+                else if(hitPolicy == WRITE_THROUGH){
+                    numMemWrite++;
+                    transfer(bytesWriteThrough, writeBytes);
                 }
             }
-            else{
+            else if(missPolicy == NO_WRITE_ALLOCATE){
+                //the word goes straight to memory
                 if(hitPolicy == WRITE_THROUGH) numMemWrite++;
+                transfer(bytesWriteThrough, writeBytes);
             }
         }
-        isFull = true;
-        number_memory_accesses++;
-        if (num_entries!=0 && (number_memory_accesses-first_access)==num_entries)
+    }
+    else return;
+
+    if(pf && (!outcome.hit || prefetchHit)) issue_prefetches(block, !outcome.hit);
+
+    if(memoryBandwidth > 0){
+        memoryClock += hitTime + (outcome.hit ? 0 : missPenalty) + accessStall;
+        stallCycles += accessStall;
+        accessStall = 0;
+    }
+}
+
+unsigned cache::fetch(long long setIndex, long long tag, unsigned line, unsigned sector){
+    bool present = (line != NO_LINE);
+    if(present){
+        numSectorMiss++;
+        touch(setIndex, line);
+        outcome.filled = true;
+    }
+    else{
+        line = allocate(setIndex, tag);
+    }
+
+    if(numSectors > 1){
+        if(present) sectorValid[line] |= (1u << sector);
+        else sectorValid[line] = (1u << sector);
+        accessStall += transfer(bytesFill, sectorSize);
+    }
+    else{
+        accessStall += transfer(bytesFill, blockSize);
+    }
+    return line;
+}
+
+void cache::mark_dirty(unsigned line, unsigned sector){
+    stateArray[line] |= LINE_DIRTY;
+    if(numSectors > 1) sectorDirty[line] |= (1u << sector);
+}
+
+void cache::mark_whole_line_dirty(unsigned line){
+    stateArray[line] |= LINE_DIRTY;
+    if(numSectors > 1) sectorDirty[line] = sectorValid[line];
+}
+
+unsigned cache::dirty_bytes(unsigned line) const{
+    if(numSectors > 1) return __builtin_popcount(sectorDirty[line]) * sectorSize;
+    return blockSize;
+}
+
+double cache::transfer(unsigned long long &counter, unsigned bytes){
+    counter += bytes;
+    if(memoryBandwidth <= 0) return 0;
+    double start = (channelFree > memoryClock) ? channelFree : memoryClock;
+    channelFree = start + bytes / memoryBandwidth;
+    return start - memoryClock;
+}
+
+bool cache::set_interval_stats(unsigned interval, const char *filename, interval_format_t format){
+    //a partial last interval is logged when logging stops
+    if(intervalLog.is_open()){
+        if(number_memory_accesses != intervalStart.end) end_interval();
+        intervalLog.close();
+    }
+    intervalLength = 0;
+    nextInterval = ~0ULL;
+    if(interval == 0) return true;
+    if(filename == NULL) return false;
+
+    if(!intervalLog.open(filename, format, interval)) return false;
+    intervalLength = interval;
+    nextInterval = number_memory_accesses + interval;
+    intervalStart = counters();
+    return true;
+}
+
+interval_sample_t cache::counters() const{
+    interval_sample_t s;
+    s.end = number_memory_accesses;
+    s.reads = numRead;
+    s.readMisses = numReadMiss;
+    s.writes = numWrite;
+    s.writeMisses = numWriteMiss;
+    s.evictions = numEvict;
+    s.memoryWrites = numMemWrite;
+    return s;
+}
+
+void cache::end_interval(){
+    interval_sample_t now = counters();
+    interval_sample_t delta = now;
+    delta.reads -= intervalStart.reads;
+    delta.readMisses -= intervalStart.readMisses;
+    delta.writes -= intervalStart.writes;
+    delta.writeMisses -= intervalStart.writeMisses;
+    delta.evictions -= intervalStart.evictions;
+    delta.memoryWrites -= intervalStart.memoryWrites;
+    intervalLog.write(delta);
+    intervalStart = now;
+    nextInterval = number_memory_accesses + intervalLength;
+}
+
+void cache::report_traffic(bool enable){
+    showTraffic = enable;
+}
+
+void cache::set_memory_bandwidth(double bytes_per_cycle){
+    memoryBandwidth = (bytes_per_cycle > 0) ? bytes_per_cycle : 0;
+}
+
+void cache::set_sectors(unsigned sectors){
+    if(sectors < 1) sectors = 1;
+    if(sectors > MAX_SECTORS) sectors = MAX_SECTORS;
+    if(sectors > blockSize) sectors = blockSize;
+    numSectors = sectors;
+    sectorSize = blockSize / numSectors;
+    sectorBits = log2(sectorSize);
+    if(numSectors > 1){
+        sectorValid.assign(c_set*numWays, 0);
+        sectorDirty.assign(c_set*numWays, 0);
+    }
+    else{
+        sectorValid.clear();
+        sectorDirty.clear();
+    }
+}
+
+void cache::set_prefetcher(prefetch_policy_t prefetch_policy, unsigned degree){
+    delete pf;
+    prefetchPolicy = prefetch_policy;
+    prefetchDegree = degree ? degree : 1;
+    pf = make_prefetcher(prefetch_policy, prefetchDegree, blockSize);
+    if(pf){
+        prefetchLatency = hitTime ? missPenalty / hitTime : missPenalty;
+        readyArray.assign(c_set*numWays, 0);
+        pollutionFilter.assign(POLLUTION_FILTER, -1);
+    }
+}
+
+void cache::issue_prefetches(long long block, bool miss){
+    //a demand miss on a block a prefetch threw out
+    if(miss){
+        long long &slot = pollutionFilter[(unsigned long long)block % POLLUTION_FILTER];
+        if(slot == block){
+            numPrefetchPolluting++;
+            slot = -1;
+        }
+    }
+
+    //prefetch fills must not hide the demand access from the level below
+    access_outcome_t demand = outcome;
+    prefetchQueue.clear();
+    pf->observe(block, miss, prefetchQueue);
+    for(unsigned i = 0; i < prefetchQueue.size(); i++){
+        long long b = prefetchQueue[i];
+        long long setIndex = (b & maskSetBits) % c_set;
+        if(findLine(setBase(setIndex), b >> setBits) != NO_LINE) continue;
+
+        outcome.evicted = false;
+        unsigned line = allocate(setIndex, b >> setBits);
+        transfer(bytesFill, blockSize);
+        stateArray[line] |= LINE_PREFETCHED;
+        readyArray[line] = number_memory_accesses + prefetchLatency;
+        numPrefetch++;
+        if(outcome.evicted){
+            long long victim = outcome.victim >> blkoffBits;
+            pollutionFilter[(unsigned long long)victim % POLLUTION_FILTER] = victim;
+        }
+    }
+    outcome = demand;
+}
+
+unsigned cache::allocate(long long setIndex, long long tag){
+    unsigned base = setBase(setIndex);
+    unsigned line = NO_LINE;
+
+    for(unsigned i = base; i < base + numWays; i++){
+        if(!(stateArray[i] & LINE_VALID)){
+            line = i;
             break;
+        }
+    }
+    if(line == NO_LINE){
+        line = base + evict(setIndex);
+        long long victim = (tagArray[line] << setBits) | setIndex;
+        bool dirty = (stateArray[line] & LINE_DIRTY) != 0;
+        outcome.evicted = true;
+        outcome.victimDirty = dirty;
+        outcome.victim = victim << blkoffBits;
+        if(!assistBuffer.empty() && assistKind == VICTIM_CACHE){
+            //the victim cache keeps the line; only what it displaces leaves this level
+            long long displaced;
+            outcome.evicted = assist_insert(victim, dirty, displaced, outcome.victimDirty);
+            outcome.victim = displaced << blkoffBits;
+            if(outcome.evicted && outcome.victimDirty){
+                numMemWrite++;
+                transfer(bytesWriteback, blockSize);
+            }
+        }
+        else if(dirty){
+            numMemWrite++;
+            transfer(bytesWriteback, dirty_bytes(line));
+        }
+        if(stateArray[line] & LINE_PREFETCHED) numPrefetchUnused++;
+    }
+    outcome.filled = true;
+    stateArray[line] = LINE_VALID;
+    tagArray[line] = tag;
+    if(numSectors > 1){
+        sectorValid[line] = (numSectors == 32) ? ~0u : ((1u << numSectors) - 1);
+        sectorDirty[line] = 0;
+    }
+    filled(setIndex, line);
+
+    if(!assistBuffer.empty() && assistKind == MISS_CACHE){
+        long long displaced;
+        bool displacedDirty;
+        assist_insert((tag << setBits) | setIndex, false, displaced, displacedDirty);
+    }
+    return line;
+}
+
+void cache::set_victim_cache(unsigned entries, assist_cache_t kind){
+    assist_entry empty = {0, false, false, 0};
+    assistKind = kind;
+    assistBuffer.assign(entries, empty);
+}
+
+unsigned cache::assist_hit(long long setIndex, long long block){
+    for(unsigned i = 0; i < assistBuffer.size(); i++){
+        assist_entry &e = assistBuffer[i];
+        if(!e.valid || e.block != block) continue;
+
+        numAssistHits++;
+        bool dirty = e.dirty;
+        if(assistKind == VICTIM_CACHE) e.valid = false; //swapped with the line allocate() evicts
+        else e.stamp = number_memory_accesses;
+        unsigned line = allocate(setIndex, block >> setBits);
+        if(dirty) mark_whole_line_dirty(line);
+        return line;
     }
+    return NO_LINE;
+}
+
+bool cache::assist_insert(long long block, bool dirty, long long &displaced, bool &displacedDirty){
+    unsigned slot = 0;
+    for(unsigned i = 0; i < assistBuffer.size(); i++){
+        assist_entry &e = assistBuffer[i];
+        if(e.valid && e.block == block){
+            e.dirty = e.dirty || dirty;
+            e.stamp = number_memory_accesses;
+            return false;
+        }
+        if(!assistBuffer[slot].valid) continue;
+        if(!e.valid || e.stamp < assistBuffer[slot].stamp) slot = i;
+    }
+
+    assist_entry &e = assistBuffer[slot];
+    bool wasValid = e.valid;
+    displaced = e.block;
+    displacedDirty = wasValid && e.dirty;
+    e.block = block;
+    e.valid = true;
+    e.dirty = dirty;
+    e.stamp = number_memory_accesses;
+    return wasValid;
+}
+
+void cache::insert_block(address_t address, bool dirty){
+    long long block = address >> blkoffBits;
+    long long setIndex = (block & maskSetBits) % c_set;
+    unsigned line = findLine(setBase(setIndex), block >> setBits);
+
+    outcome = access_outcome_t();
+    outcome.hit = (line != NO_LINE);
+    if(line == NO_LINE) line = allocate(setIndex, block >> setBits);
+    if(dirty) mark_whole_line_dirty(line);
+}
+
+bool cache::extract(address_t address, bool &dirty){
+    long long block = address >> blkoffBits;
+    unsigned line = findLine(setBase((block & maskSetBits) % c_set), block >> setBits);
+    if(line == NO_LINE) return false;
+    dirty = (stateArray[line] & LINE_DIRTY) != 0;
+    stateArray[line] = 0;
+    return true;
+}
+
+unsigned cache::invalidate_range(address_t start, unsigned bytes, bool &dirty){
+    unsigned found = 0;
+    dirty = false;
+    start &= ~(address_t)(bytes - 1);
+    for(address_t a = start; a < start + bytes; a += blockSize){
+        bool lineDirty;
+        if(extract(a, lineDirty)){
+            found++;
+            dirty = dirty || lineDirty;
+        }
+    }
+    return found;
+}
+
+bool cache::holds(address_t address){
+    long long block = address >> blkoffBits;
+    return findLine(setBase((block & maskSetBits) % c_set), block >> setBits) != NO_LINE;
+}
+
+void cache::touch(long long setIndex, unsigned line){
+    if(policy) policy->on_hit(setIndex, line - setBase(setIndex));
+    else lruArray[line] = number_memory_accesses;
+}
+
+void cache::filled(long long setIndex, unsigned line){
+    if(policy) policy->on_fill(setIndex, line - setBase(setIndex));
+    else lruArray[line] = number_memory_accesses;
 }
 
 void cache::print_statistics(){
-    float missRate;
 	cout << "STATISTICS" << endl;
 	/* edit here */
-	missRate = (float(numWriteMiss) + float(numReadMiss))/float(number_memory_accesses);
-	AvgMem_time = float(hitTime) + (missRate * float(missPenalty));
+	AvgMem_time = average_access_time();
 
-    cout << "memory accesses = " << dec << number_memory_accesses <<endl;
+    cout << "memory accesses = " << dec << counted_accesses() <<endl;
     cout << "read = " << dec << numRead <<endl;
     cout << "read misses = " << dec << numReadMiss <<endl;
     cout << "write = " << dec << numWrite <<endl;
@@ -244,36 +834,145 @@ void cache::print_statistics(){
     cout << "evictions = " << dec << numEvict <<endl;
     cout << "memory writes = " << dec << numMemWrite <<endl;
     cout << "average memory access time = " << dec << AvgMem_time <<endl;
+    if(numSectors > 1){
+        cout << "sector misses = " << dec << numSectorMiss <<endl;
+    }
+    if(showTraffic || numSectors > 1 || memoryBandwidth > 0){
+        cout << "fill traffic = " << dec << bytesFill << " B" <<endl;
+        cout << "writeback traffic = " << dec << bytesWriteback << " B" <<endl;
+        cout << "write-through traffic = " << dec << bytesWriteThrough << " B" <<endl;
+    }
+    if(memoryBandwidth > 0){
+        cout << "bandwidth stall cycles = " << dec << (unsigned long long)stallCycles <<endl;
+        cout << "bandwidth-bound average memory access time = " << dec
+             << AvgMem_time + stallCycles / counted_accesses() <<endl;
+    }
+    if(classifier){
+        cout << "compulsory misses = " << dec << classifier->numCompulsory <<endl;
+        cout << "capacity misses = " << dec << classifier->numCapacity <<endl;
+        cout << "conflict misses = " << dec << classifier->numConflict <<endl;
+    }
+    if(numMshrs){
+        cout << "primary misses = " << dec << numPrimaryMiss <<endl;
+        cout << "secondary misses merged = " << dec << numSecondaryMiss <<endl;
+        cout << "MSHR full stalls = " << dec << numMshrStall << " (" << mshrStallCycles << " CLK)" <<endl;
+        cout << "memory-level parallelism = " << (missBusyCycles ? double(missCycles) / double(missBusyCycles) : 0.0) <<endl;
+        cout << "average access latency = " << double(accessCycles) / counted_accesses() <<endl;
+        cout << "execution cycles = " << dec << mshrFinish <<endl;
+        cout << "cycles per access = " << double(mshrFinish) / counted_accesses() <<endl;
+    }
+    if(samplingMode != SAMPLE_NONE){
+        sample_estimate_t e = sampling_estimate();
+        cout << "sampled accesses = " << dec << e.measured << " of " << e.accesses <<endl;
+        cout << "estimated miss rate = " << e.missRate << " +/- " << e.missRateError << " (95%)" <<endl;
+        cout << "estimated misses = " << (unsigned long long)(e.misses + 0.5) <<endl;
+        cout << "estimated evictions = " << (unsigned long long)(e.evictions + 0.5) <<endl;
+        cout << "estimated memory writes = " << (unsigned long long)(e.memoryWrites + 0.5) <<endl;
+        cout << "estimated average memory access time = " << e.amat <<endl;
+    }
+    if(!assistBuffer.empty()){
+        cout << (assistKind == VICTIM_CACHE ? "victim cache hits = " : "miss cache hits = ") << dec << numAssistHits <<endl;
+    }
+    if(pf){
+        cout << "prefetches issued = " << dec << numPrefetch <<endl;
+        cout << "useful prefetches = " << dec << numPrefetchUseful <<endl;
+        cout << "late prefetches = " << dec << numPrefetchLate <<endl;
+        cout << "polluting prefetches = " << dec << numPrefetchPolluting <<endl;
+        cout << "unused prefetches evicted = " << dec << numPrefetchUnused <<endl;
+    }
+    if(tlbs){
+        tlbs->print_statistics();
+        cout << "average translation time = " << double(translationCycles) / counted_accesses() <<endl;
+        cout << "average memory access time with translation = " << AvgMem_time + double(translationCycles) / counted_accesses() <<endl;
+    }
+    if(profile){
+        cout << endl;
+        profile->print(profileTop);
+    }
+
+}
+
+cache_stats_t cache::statistics() const{
+    cache_stats_t s;
+    s.accesses = counted_accesses();
+    s.reads = numRead;
+    s.readMisses = numReadMiss;
+    s.writes = numWrite;
+    s.writeMisses = numWriteMiss;
+    s.evictions = numEvict;
+    s.memoryWrites = numMemWrite;
+    s.sectorMisses = numSectorMiss;
+    s.assistHits = numAssistHits;
+    s.prefetches = numPrefetch;
+    s.usefulPrefetches = numPrefetchUseful;
+    s.latePrefetches = numPrefetchLate;
+    s.pollutingPrefetches = numPrefetchPolluting;
+    s.unusedPrefetches = numPrefetchUnused;
+    s.bytesFill = bytesFill;
+    s.bytesWriteback = bytesWriteback;
+    s.bytesWriteThrough = bytesWriteThrough;
+    s.stallCycles = (unsigned long long)stallCycles;
+    s.translationCycles = translationCycles;
+    s.amat = counted_accesses() ? average_access_time() : 0;
+    return s;
+}
+
+void cache::accumulate_statistics(cache_stats_t &total) const{
+    cache_stats_t s = statistics();
+    unsigned long long accesses = total.accesses + s.accesses;
+    if(accesses) total.amat = (total.amat * total.accesses + s.amat * s.accesses) / accesses;
+    total.accesses = accesses;
+    total.reads += s.reads;
+    total.readMisses += s.readMisses;
+    total.writes += s.writes;
+    total.writeMisses += s.writeMisses;
+    total.evictions += s.evictions;
+    total.memoryWrites += s.memoryWrites;
+    total.sectorMisses += s.sectorMisses;
+    total.assistHits += s.assistHits;
+    total.prefetches += s.prefetches;
+    total.usefulPrefetches += s.usefulPrefetches;
+    total.latePrefetches += s.latePrefetches;
+    total.pollutingPrefetches += s.pollutingPrefetches;
+    total.unusedPrefetches += s.unusedPrefetches;
+    total.bytesFill += s.bytesFill;
+    total.bytesWriteback += s.bytesWriteback;
+    total.bytesWriteThrough += s.bytesWriteThrough;
+    total.stallCycles += s.stallCycles;
+    total.translationCycles += s.translationCycles;
+}
 
+float cache::average_access_time() const{
+    float missRate = (float(numWriteMiss) + float(numReadMiss))/float(counted_accesses());
+    return float(hitTime) + (missRate * float(missPenalty));
 }
 
 access_type_t cache::read(address_t address){
 	long long cachetag = address >> (blkoffBits + setBits);
 	long long cacheset = (address >> blkoffBits) & maskSetBits;
 	long long setnum = cacheset % c_set;
-	for(unsigned i = 0; i < numWays; i++){
-	    if(cacheTable[i][setnum].valid == 1 &&
-	    cacheTable[i][setnum].tag == cachetag){
-            cacheTable[i][setnum].LRU = number_memory_accesses;
-            return HIT;
-	    }
-	}
-	return MISS;
+	unsigned line = findLine(setBase(setnum), cachetag);
+	if(line == NO_LINE) return MISS;
+	touch(setnum, line);
+	return HIT;
 }
 
 access_type_t cache::write(address_t address){
     long long cachetag = address >> (blkoffBits + setBits);
     long long cacheset = (address >> blkoffBits) & maskSetBits;
     long long setnum = cacheset % c_set;
-    for(unsigned i = 0; i < numWays; i++){
-        if(cacheTable[i][setnum].valid == 1 &&
-           cacheTable[i][setnum].tag == cachetag){
-            if(hitPolicy == WRITE_BACK) cacheTable[i][setnum].dirty = 1;
-            cacheTable[i][setnum].LRU = number_memory_accesses;
-            return HIT;
-        }
+    unsigned line = findLine(setBase(setnum), cachetag);
+    if(line == NO_LINE) return MISS;
+    if(hitPolicy == WRITE_BACK) stateArray[line] |= LINE_DIRTY;
+    touch(setnum, line);
+    return HIT;
+}
+
+unsigned cache::findLine(unsigned base, long long tag){
+    for(unsigned i = base; i < base + numWays; i++){
+        if((stateArray[i] & LINE_VALID) && tagArray[i] == tag) return i;
     }
-	return MISS;
+    return NO_LINE;
 }
 
 void cache::print_tag_array(){
@@ -283,8 +982,9 @@ void cache::print_tag_array(){
         if (hitPolicy == WRITE_BACK) {
             cout << setfill(' ') << setw(7) << "index" << setw(6) << "dirty" << setw(4 + tagBits/4) << "tag" <<endl;
             for (unsigned j = 0; j < c_set; j++) {
-                if (cacheTable[i][j].valid == 1) {
-                    cout << setfill(' ') << setw(7) << dec << cacheTable[i][j].set << setw(6) << dec << cacheTable[i][j].dirty << setw(4) << "0x" << hex << cacheTable[i][j].tag <<endl;
+                unsigned line = setBase(j) + i;
+                if (stateArray[line] & LINE_VALID) {
+                    cout << setfill(' ') << setw(7) << dec << j << setw(6) << dec << ((stateArray[line] & LINE_DIRTY) ? 1 : 0) << setw(4) << "0x" << hex << tagArray[line] <<endl;
                 }
             }
 
@@ -292,8 +992,9 @@ void cache::print_tag_array(){
         else {
             cout << setfill(' ') << setw(7) << "index" << setw(6) << setw(4 + tagBits/4) << "tag" <<endl;
             for (unsigned j = 0; j < c_set; j++) {
-                if (cacheTable[i][j].valid == 1) {
-                    cout << setfill(' ') << setw(7) << dec << cacheTable[i][j].set << setw(4) << "0x" << hex << cacheTable[i][j].tag <<endl;
+                unsigned line = setBase(j) + i;
+                if (stateArray[line] & LINE_VALID) {
+                    cout << setfill(' ') << setw(7) << dec << j << setw(4) << "0x" << hex << tagArray[line] <<endl;
                 }
             }
         }
@@ -303,13 +1004,20 @@ void cache::print_tag_array(){
 }
 
 unsigned cache::evict(unsigned index){
+	numEvict++;
+	return victim_way(index);
+}
+
+unsigned cache::victim_way(unsigned index){
+	if(policy) return policy->victim(index);
+
 	unsigned way = 0;
-	unsigned smallestLRU = number_memory_accesses;
+	unsigned long long smallestLRU = number_memory_accesses;
+	const unsigned long long *lru = &lruArray[setBase(index)];
 
-	numEvict++;
 	for(unsigned i = 0; i < numWays; i++){
-	    if(cacheTable[i][index].LRU <= smallestLRU){
-	        smallestLRU = cacheTable[i][index].LRU;
+	    if(lru[i] <= smallestLRU){
+	        smallestLRU = lru[i];
 	        way = i;
 	    }
 	}
@@ -13,6 +13,13 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include "trace.h"
+#include "replacement.h"
+#include "prefetcher.h"
+#include "interval.h"
+#include "profile.h"
+#include "classify.h"
+#include "tlb.h"
 
 using namespace std;
 
@@ -22,17 +29,116 @@ typedef enum {WRITE_BACK, WRITE_THROUGH, WRITE_ALLOCATE, NO_WRITE_ALLOCATE} writ
 
 typedef enum {HIT, MISS} access_type_t;
 
+typedef enum {VICTIM_CACHE, MISS_CACHE} assist_cache_t;
+
+typedef enum {SAMPLE_NONE, SAMPLE_SETS, SAMPLE_INTERVALS} sampling_mode_t;
+
 typedef long long address_t; //memory address type
 
+//per-line state bits kept in the metadata array
+#define LINE_VALID 0x1
+#define LINE_DIRTY 0x2
+#define LINE_PREFETCHED 0x4 //brought in by the prefetcher and not yet used
+#define LINE_SHARED 0x8     //other caches of a coherent_system may hold a copy
+
+#define NO_LINE 0xFFFFFFFF //returned by a set lookup that misses
+
+#define MAX_SECTORS 32      //sectors per line, one bit each in the sector masks
+#define WRITE_BYTES 8       //traces carry no access size, so a write sent to memory moves one 8-byte word
+
+//one entry of the fully-associative victim/miss cache
+typedef struct{
+    long long block;
+    bool valid;
+    bool dirty;
+    unsigned long long stamp;   //LRU timestamp
+} assist_entry;
+
+//a block being fetched, held in a miss status holding register
+typedef struct{
+    long long block;
+    unsigned long long ready;   // cycle the block arrives
+} mshr_entry;
+
+//what the latest access did to the cache, for the level below it
 typedef struct{
-    unsigned valid;
-    unsigned dirty;
-    //double set;
-    //double tag;
-    long long set;
-    long long tag;
-    unsigned LRU;
-} cache_entries;
+    bool hit;
+    bool filled;            // a line was allocated for the block
+    bool evicted;           // a valid line was replaced to make room
+    bool victimDirty;       // the replaced line was dirty
+    address_t victim;       // byte address of the replaced block
+} access_outcome_t;
+
+//one memory request for cache::access_many
+typedef struct{
+    address_t address;
+    char op;                // 'r' or 'w'
+    unsigned size;          // bytes accessed
+} access_request_t;
+
+//what cache::access did for a request
+typedef struct{
+    access_type_t type;     // MISS if any line (or sector) touched by the request missed
+    unsigned latency;       // clock cycles, including bandwidth stalls
+} access_result_t;
+
+//whole-trace estimate of a sampled run, as returned by cache::sampling_estimate()
+typedef struct{
+    unsigned long long accesses;            // reads and writes run through, sampled or not
+    unsigned long long measured;            // reads and writes that were measured
+    unsigned units;                         // sampled sets or detailed windows with accesses
+    double missRate;
+    double missRateError;                   // half-width of the 95% confidence interval
+    double misses;
+    double evictions;
+    double memoryWrites;
+    double amat;
+} sample_estimate_t;
+
+//statistics of a cache, as returned by cache::statistics(); counters that belong
+//to a feature that is off (sectors, prefetching, ...) are 0
+typedef struct{
+    unsigned long long accesses;
+    unsigned long long reads;
+    unsigned long long readMisses;
+    unsigned long long writes;
+    unsigned long long writeMisses;
+    unsigned long long evictions;
+    unsigned long long memoryWrites;
+    unsigned long long sectorMisses;
+    unsigned long long assistHits;          // victim or miss cache hits
+    unsigned long long prefetches;
+    unsigned long long usefulPrefetches;
+    unsigned long long latePrefetches;
+    unsigned long long pollutingPrefetches;
+    unsigned long long unusedPrefetches;
+    unsigned long long bytesFill;
+    unsigned long long bytesWriteback;
+    unsigned long long bytesWriteThrough;
+    unsigned long long stallCycles;         // bandwidth stalls
+    unsigned long long translationCycles;   // address translation not hidden behind the cache lookup
+    double amat;                            // average memory access time, without bandwidth stalls
+} cache_stats_t;
+
+class cache;
+
+//what a specialized replay loop adds up; the caller merges it into the cache
+typedef struct{
+    unsigned long long clock;           //access number of the next entry
+    unsigned long long reads;
+    unsigned long long readMisses;
+    unsigned long long writes;
+    unsigned long long writeMisses;
+    unsigned long long evictions;
+    unsigned long long memoryWrites;
+    unsigned long long fills;           //lines brought in
+    unsigned long long writebacks;      //dirty lines written back
+    unsigned long long writesThrough;   //words sent past the cache
+} kernel_counts_t;
+
+//a replay loop of a plain LRU cache specialized for one associativity and pair of
+//write policies (see kernel.cc); "blocks" are addresses with the block offset shifted out
+typedef void (*cache_kernel_t)(cache &c, const char *ops, const long long *blocks, unsigned count, kernel_counts_t &n);
 
 class cache{
 	/* Add the data members required by your simulator's implementation here */
@@ -46,12 +152,12 @@ class cache{
     unsigned memAddressSize;
 
     //Statistics
-    unsigned numRead;
-    unsigned numReadMiss;
-    unsigned numWrite;
-    unsigned numWriteMiss;
-    unsigned numEvict;
-    unsigned numMemWrite;
+    unsigned long long numRead;
+    unsigned long long numReadMiss;
+    unsigned long long numWrite;
+    unsigned long long numWriteMiss;
+    unsigned long long numEvict;
+    unsigned long long numMemWrite;
     float AvgMem_time;
 
     //Cache Table
@@ -65,14 +171,124 @@ class cache{
     long long maskSetBits;
     //long long maskTagBits;
 
-    //Cache Table Vector of Vectors
-    vector <vector<cache_entries>> cacheTable;
+    //Cache Table, flat and set-major: line (set, way) lives at set*numWays + way
+    vector<long long> tagArray;         //tags
+    vector<unsigned char> stateArray;   //LINE_VALID | LINE_DIRTY
+    vector<unsigned long long> lruArray; //timestamp of last access (LRU only)
+
+    //Replacement
+    replacement_policy_t replacement;
+    replacement_policy *policy;         //state of any policy other than LRU, NULL for LRU
+
+    //Prefetching
+    prefetch_policy_t prefetchPolicy;
+    unsigned prefetchDegree;
+    prefetcher *pf;                     //NULL when prefetching is off
+    unsigned prefetchLatency;           //accesses a prefetch takes to arrive
+    vector<unsigned long long> readyArray; //access number at which a prefetched line arrives
+    vector<long long> pollutionFilter;  //blocks recently evicted by prefetch fills
+    vector<long long> prefetchQueue;    //blocks requested by the prefetcher
+    unsigned long long numPrefetch;
+    unsigned long long numPrefetchUseful;
+    unsigned long long numPrefetchLate;
+    unsigned long long numPrefetchPolluting;
+    unsigned long long numPrefetchUnused;
+
+    //specialized replay loop used while no feature beyond plain LRU is on
+    cache_kernel_t kernel;
+
+    //result of the latest access_block or insert_block
+    access_outcome_t outcome;
+
+    //Sectors: per-sector valid and dirty masks, only kept when a line has more than one sector
+    unsigned numSectors;
+    unsigned sectorSize;
+    unsigned sectorBits;                //log2 of the sector size
+    vector<unsigned> sectorValid;
+    vector<unsigned> sectorDirty;
+    unsigned long long numSectorMiss;   //misses on a line that was present without the sector
+
+    //Memory traffic, in bytes moved to or from the next level
+    unsigned long long bytesFill;           //demand and prefetch fills
+    unsigned long long bytesWriteback;      //dirty lines written back
+    unsigned long long bytesWriteThrough;   //writes sent past the cache (write-through or no-write-allocate)
+    bool showTraffic;
+
+    //Bandwidth-limited memory: transfers occupy a single channel, and a fill queued
+    //behind earlier transfers delays the access that missed
+    double memoryBandwidth;                 //bytes per clock cycle, 0 for unlimited
+    double memoryClock;                     //cycle at which the current access starts
+    double channelFree;                     //cycle at which the channel finishes its queued transfers
+    double accessStall;                     //queueing delay of the current access
+    double stallCycles;
+    unsigned writeBytes;                    //bytes the current write sends to memory
+
+    //Interval statistics
+    interval_log intervalLog;
+    unsigned intervalLength;            //0 when interval logging is off
+    unsigned long long nextInterval;    //access count that closes the current interval (~0 when off)
+    interval_sample_t intervalStart;    //cumulative counters when the current interval began
+
+    //Non-blocking timing: an access issues every issueInterval cycles, misses wait in MSHRs
+    //while later accesses go ahead, and issue stalls only when every MSHR is busy
+    unsigned numMshrs;                  //0 for the blocking model
+    unsigned issueInterval;
+    vector<mshr_entry> mshrs;           //blocks in flight
+    unsigned long long mshrClock;       //cycle the next access issues
+    unsigned long long mshrFinish;      //cycle the last access completes
+    unsigned long long mshrCovered;     //end of the union of the miss intervals so far
+    unsigned long long missBusyCycles;  //cycles with at least one miss outstanding
+    unsigned long long missCycles;      //summed latency of the primary misses
+    unsigned long long accessCycles;    //summed latency of all accesses, from their turn to issue
+    unsigned long long numPrimaryMiss;
+    unsigned long long numSecondaryMiss; //misses merged into an MSHR already fetching the block
+    unsigned long long numMshrStall;
+    unsigned long long mshrStallCycles;
+
+    //Miss attribution per PC, page and data-structure tag (NULL when off)
+    miss_profile *profile;
+    unsigned profileTop;                //rows printed per table
+
+    //3C miss classification (NULL when off)
+    miss_classifier *classifier;
+
+    //Address translation: trace addresses are virtual and go through the TLBs first (NULL when off);
+    //a virtually-indexed, physically-tagged cache takes its set from the virtual address and hides
+    //the first TLB lookup behind the set read
+    tlb_hierarchy *tlbs;
+    bool vipt;
+    unsigned pageOffsetBits;            //bits the virtual and physical addresses always share
+    unsigned long long translationCycles;
+
+    //Sampling: either one set in sampleSets is simulated, or each period of samplePeriod
+    //accesses is skipped, then warmed for sampleWarmup accesses and measured for sampleDetail
+    sampling_mode_t samplingMode;
+    unsigned sampleSets;
+    unsigned samplePeriod;
+    unsigned sampleWarmup;
+    unsigned sampleDetail;
+    unsigned long long sampleTotal;         //reads and writes seen, sampled or not
+    vector<unsigned> sampleAccesses;        //per sampled set or detailed window
+    vector<unsigned> sampleMisses;
+    unsigned long long sampleEvict;         //evictions and memory writes of the measured accesses
+    unsigned long long sampleMemWrite;
+    unsigned long long windowEvict;         //counters when the open window began
+    unsigned long long windowMemWrite;
+    bool windowOpen;
+
+    //Victim cache (holds lines evicted from the cache) or miss cache (holds copies of missed blocks)
+    assist_cache_t assistKind;
+    vector<assist_entry> assistBuffer;  //empty when there is none
+    unsigned long long numAssistHits;
 
 	/* number of memory accesses processed */
-	unsigned number_memory_accesses = 0;
+	unsigned long long number_memory_accesses = 0;
+
+	/* accesses of a warm-up restored from a checkpoint without its statistics, left out of the counts */
+	unsigned long long warmAccesses;
 
-	/* trace file input stream */	
-	ifstream stream;
+	/* memory-mapped trace file */
+	trace_reader trace;
 
 
 public:
@@ -87,28 +303,133 @@ public:
 	      write_policy_t write_miss_policy, // write-allocate or no-write-allocate
 	      unsigned cache_hit_time,		// cache hit time (in clock cycles)
 	      unsigned cache_miss_penalty,	// cache miss penalty (in clock cycles)	
-	      unsigned address_width            // number of bits in memory address
+	      unsigned address_width,           // number of bits in memory address
+	      replacement_policy_t cache_replacement=REPLACE_LRU // replacement policy
 	);	
 	
 	// de-allocates the cache simulator
 	~cache();
 
 	// loads the trace file (with name "filename") so that it can be used by the "run" function  
-	void load_trace(const char *filename);
+	// the text or binary format is detected from the file unless "format" says otherwise
+	// returns false if the trace cannot be opened or is a truncated or unsupported binary trace
+	bool load_trace(const char *filename, trace_format_t format=TRACE_AUTO);
 
 	// processes "num_memory_accesses" memory accesses (i.e., entries) from the input trace 
 	// if "num_memory_accesses=0" (default), then it processes the trace to completion 
 	void run(unsigned num_memory_accesses=0);
+
+	// same as "run", but the sets are split across "threads" worker threads while this thread parses the trace
+	// (0 = one per remaining hardware thread, which is just "run" on a single hardware thread)
+	// the statistics and the final tag array are identical to those of "run"
+	// (policies other than LRU, prefetchers and victim caches share state across sets, so they fall back to "run",
+	// as do sectored caches, bandwidth-limited memory, interval logging, sampling, MSHRs, miss profiles,
+	// miss classification and address translation)
+	void run_sharded(unsigned num_memory_accesses=0, unsigned threads=0);
 	
-	// processes a read operation and returns hit/miss
+	// simulates one access of "size" bytes with the full fill, eviction and writeback path, as "run" does
+	// for a trace entry; an access spanning several lines (or sectors) counts once per line (or sector),
+	// a "size" of 0 counts as 1 and an access running past the top of the address space is cut off there
+	access_result_t access(address_t address, char op, unsigned size=1);
+
+	// simulates "count" requests in order, storing their results in "results" unless it is NULL;
+	// returns the number of hits
+	unsigned access_many(const access_request_t *requests, unsigned count, access_result_t *results=NULL);
+
+	// looks up a read and returns hit/miss, updating only the replacement state
 	access_type_t read(address_t address);
 	
-	// processes a write operation and returns hit/miss
+	// looks up a write and returns hit/miss, updating only the replacement state and dirty bit
 	access_type_t write(address_t address);
 
 	// returns the next block to be evicted from the cache
 	unsigned evict(unsigned index);
 	
+	// attaches a prefetcher issuing up to "degree" blocks per trigger (PREFETCH_NONE detaches it)
+	// a prefetch is late if its block is used within miss penalty / hit time accesses of being issued
+	void set_prefetcher(prefetch_policy_t prefetch_policy, unsigned degree=1);
+
+	// splits every line into "sectors" sectors (a power of two, at most MAX_SECTORS) with their own
+	// valid and dirty bits, so misses fill and writebacks write only the sectors involved;
+	// call before the first access
+	void set_sectors(unsigned sectors);
+
+	// adds the fill, writeback and write-through traffic, in bytes, to the printed statistics
+	void report_traffic(bool enable=true);
+
+	// limits memory to "bytes_per_cycle" bytes per clock cycle (0 removes the limit); fills then wait
+	// for the transfers queued ahead of them and the stall is added to the average access time
+	void set_memory_bandwidth(double bytes_per_cycle);
+
+	// attributes misses, evictions and dirty writebacks to the PC, the page ("page_size" bytes) and the
+	// data-structure tag of each access, read from optional trace fields ("r 0x7fff5a8487f0 0x4005d2 0x3"),
+	// and prints the "top" entries of each (0 turns profiling off); call before "run"
+	void set_miss_profile(unsigned top, unsigned page_size=4096);
+
+	// splits the misses of the following accesses into compulsory, capacity and conflict misses,
+	// using a fully-associative LRU shadow cache of the same size (false turns it off)
+	void set_miss_classification(bool enable=true);
+
+	// treats the addresses given to "run" and "access" as virtual and translates them with "translation"
+	// (the cache takes ownership; NULL removes it); with "virtually_indexed" the set comes from the virtual
+	// address, the tag array then holds physical page numbers, and index bits above the smallest page
+	// offset are reported as possible synonyms; the statistics add the TLB misses, page walks and the
+	// average translation time; call before the first access
+	void set_translation(tlb_hierarchy *translation, bool virtually_indexed=false);
+
+	// switches to the non-blocking timing model with "entries" MSHRs (0 restores the blocking model),
+	// one access issuing every "issue_interval" cycles; misses to a block already being fetched are
+	// merged, and the statistics add memory-level parallelism, the mean latency of an access and
+	// the execution cycles per access, which shrink below that latency as misses overlap
+	void set_mshrs(unsigned entries, unsigned issue_interval=1);
+
+	// lets plain LRU caches of 8, 16 or 32 ways replay traces with the AVX2 kernels when the host has
+	// AVX2 (the default), or keeps them on the scalar ones; both give the same results
+	void set_simd_kernels(bool enable=true);
+
+	// writes the tag store, dirty and sector bits, replacement state, victim/miss cache, counters
+	// and trace position to a binary snapshot; returns false on an I/O error, or if a feature whose
+	// state is not saved is on: a prefetcher, MSHRs, bandwidth-limited memory, sampling, a miss
+	// profile, miss classification or address translation
+	bool save_checkpoint(const char *filename);
+
+	// restores a snapshot taken from a cache of the same configuration, resuming the loaded trace
+	// (load it first) where the snapshot left off; unless "restore_statistics" is set the counters
+	// start from 0, so only what follows the warm-up is counted; returns false if the file cannot
+	// be read, does not match the configuration (victim/miss cache kind included) or lies past the
+	// end of the loaded trace
+	bool load_checkpoint(const char *filename, bool restore_statistics=false);
+
+	// simulates only the sets whose index is a multiple of "one_in" (1 turns sampling off);
+	// sampling_estimate() then scales their statistics up to the whole cache
+	void set_set_sampling(unsigned one_in);
+
+	// splits the trace into periods of "period" accesses: the start of each only updates the tags and
+	// replacement state (functional warming), the next "warmup" accesses are simulated in full without
+	// being measured and the last "detail" are measured
+	// (period 0 turns sampling off); warmup >= period - detail warms the cache with every access
+	void set_interval_sampling(unsigned period, unsigned detail, unsigned warmup);
+
+	// estimates the whole-trace statistics from a sampled run, with a 95% confidence interval
+	// on the miss rate taken over the sampled sets or windows
+	sample_estimate_t sampling_estimate() const;
+
+	// logs the reads, misses, evictions and memory writes of every "interval" accesses made by "run"
+	// to "filename" (interval 0 stops logging); returns false if no file is given or it cannot be created
+	bool set_interval_stats(unsigned interval, const char *filename=NULL, interval_format_t format=INTERVAL_CSV);
+
+	// attaches a fully-associative buffer of "entries" blocks (0 removes it), probed on a miss before
+	// the miss counts: a VICTIM_CACHE catches evicted lines and swaps them back in on a hit,
+	// a MISS_CACHE keeps clean copies of recently missed blocks
+	void set_victim_cache(unsigned entries, assist_cache_t kind=VICTIM_CACHE);
+
+	// returns the statistics gathered so far
+	cache_stats_t statistics() const;
+
+	// adds the statistics gathered so far to "total", which can collect several runs or caches
+	// (the average access time becomes the access-weighted mean)
+	void accumulate_statistics(cache_stats_t &total) const;
+
 	// prints the cache configuration
 	void print_configuration();
 	
@@ -119,6 +440,118 @@ public:
 	void print_tag_array();
 
     long long getMemAddrBits(long long numofbits, long long position);
+
+private:
+    // index of the first line of a set in the flat tag store
+    unsigned setBase(long long setIndex) const { return unsigned(setIndex) * numWays; }
+
+    // returns the valid line holding "tag" in the set starting at "base", or NO_LINE
+    unsigned findLine(unsigned base, long long tag);
+
+    // updates the replacement state of a line that was hit or just filled
+    void touch(long long setIndex, unsigned line);
+    void filled(long long setIndex, unsigned line);
+
+    // simulates one trace entry; "block" is the address with the block offset shifted out
+    // and "sector" the sector of the line it falls in
+    void access_block(char op, long long block, unsigned sector=0);
+
+    // simulates one access to the line (or sector) holding "address" and advances the access count
+    void step(char op, address_t address);
+
+    // translates "address" to its physical address, counting the translation time unless "counted"
+    // is false; returns the block number that indexes the cache (with the virtual set bits under VIPT)
+    long long translate(address_t &address, bool counted=true);
+
+    // "run" when sampling is on
+    void run_sampled(unsigned num_entries);
+
+    // functional warming: brings "block" in and updates the replacement state as "access_block"
+    // would, but counts nothing and leaves the prefetcher, victim cache, traffic and timing alone
+    void warm_block(char op, long long block, unsigned sector);
+
+    // way "evict" picks in the set "index", without counting the eviction
+    unsigned victim_way(unsigned index);
+
+    // times an access under the non-blocking model; "fetch" is set when it missed and
+    // needs the block from memory
+    void mshr_access(long long block, bool fetch);
+
+    // simulates "count" pre-decoded trace entries in order
+    void replay(const char *ops, const long long *blocks, unsigned count);
+
+    // whether the cache is plain LRU with every optional feature off, so that
+    // accesses can go through the specialized kernel (and run_sharded can split sets)
+    bool plain_lru() const;
+
+    // returns the specialized replay loop for a geometry and pair of write policies
+    // ("simd" allows the AVX2 loops)
+    static cache_kernel_t select_kernel(unsigned ways, write_policy_t hit_policy, write_policy_t miss_policy, bool simd);
+
+    // kernel_counts_t starting at "clock", and merging one back into the statistics
+    static kernel_counts_t kernel_counts(unsigned long long clock);
+    void merge_kernel_counts(const kernel_counts_t &n);
+
+    // accesses the statistics cover
+    unsigned long long counted_accesses() const { return number_memory_accesses - warmAccesses; }
+
+    // hit time plus miss rate times miss penalty
+    float average_access_time() const;
+
+    // brings "tag" into a set, evicting (and writing back) a line if the set is full;
+    // every sector of the new line starts valid and clean
+    unsigned allocate(long long setIndex, long long tag);
+
+    // reads a demand miss in from memory: the whole line, or only "sector" of a sectored one;
+    // "line" already holds the tag on a sector miss, and is NO_LINE otherwise
+    unsigned fetch(long long setIndex, long long tag, unsigned line, unsigned sector);
+
+    // marks a line, and the written sector, dirty
+    void mark_dirty(unsigned line, unsigned sector);
+
+    // marks a line handed over as a whole (a writeback or victim) dirty in every sector
+    void mark_whole_line_dirty(unsigned line);
+
+    // bytes a dirty line writes back
+    unsigned dirty_bytes(unsigned line) const;
+
+    // counts "bytes" moved over the memory channel; returns how long the transfer
+    // waited behind earlier ones when bandwidth is limited
+    double transfer(unsigned long long &counter, unsigned bytes);
+
+    // looks for a missing block in the victim/miss cache and, if found, brings it
+    // back into the cache; returns its line, or NO_LINE
+    unsigned assist_hit(long long setIndex, long long block);
+
+    // puts a block in the victim/miss cache; returns whether a valid entry was displaced
+    bool assist_insert(long long block, bool dirty, long long &displaced, bool &displacedDirty);
+
+    // cumulative counters, as an interval sample ending now
+    interval_sample_t counters() const;
+
+    // logs the interval ending at the current access and starts the next one
+    void end_interval();
+
+    // runs the prefetcher after a demand miss or the first hit on a prefetched line
+    void issue_prefetches(long long block, bool miss);
+
+    // places a block handed down by an upper level (a victim or a writeback) without
+    // counting an access; the block is allocated if missing and marked dirty if "dirty"
+    void insert_block(address_t address, bool dirty);
+
+    // removes a block if present; returns whether it was, and whether it was dirty
+    bool extract(address_t address, bool &dirty);
+
+    // removes every block inside [start, start+bytes); returns how many were present
+    unsigned invalidate_range(address_t start, unsigned bytes, bool &dirty);
+
+    // returns whether the block is present, without touching the replacement state
+    bool holds(address_t address);
+
+    template <unsigned WAYS, write_policy_t HIT_POLICY, write_policy_t MISS_POLICY, class PROBE> friend class lru_kernel;
+    friend class cache_sweep;
+    friend class cache_hierarchy;
+    friend class coherent_system;
 };
 
 #endif /*CACHE_H_*/
\ No newline at end of file
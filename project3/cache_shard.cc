@@ -0,0 +1,125 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#include "cache.h"
+#include <atomic>
+#include <thread>
+#include <algorithm>
+
+//Set-sharded simulation of one cache. Under LRU, accesses to different sets
+//never interact, so the main thread parses the trace and routes every entry
+//to the worker that owns its set through a single-producer/single-consumer
+//ring. Each worker runs the cache's specialized kernel straight on the ring,
+//writing only the lines of its own contiguous range of sets in the shared
+//tag, state and LRU arrays and its own counters. A worker numbers its entries
+//from the first access of the run, so LRU stamps keep the order of accesses
+//within every set (though not their global values), which makes every
+//per-set decision, and therefore every counter, identical to run().
+
+#define SHARD_RING 65536   //entries per ring (power of two)
+#define SHARD_PUBLISH 256  //entries written before the producer publishes them
+
+class shard_ring{
+    vector<char> ops;
+    vector<long long> blocks;
+    atomic<size_t> head;    //next entry the consumer reads
+    atomic<size_t> tail;    //entries published by the producer
+    atomic<bool> done;
+    size_t written;         //producer-private: entries written so far
+
+public:
+    shard_ring() : ops(SHARD_RING), blocks(SHARD_RING), head(0), tail(0), done(false), written(0) {}
+
+    void push(char op, long long block){
+        while(written - head.load(memory_order_acquire) == SHARD_RING){
+            tail.store(written, memory_order_release);
+            this_thread::yield();
+        }
+        ops[written & (SHARD_RING - 1)] = op;
+        blocks[written & (SHARD_RING - 1)] = block;
+        written++;
+        if((written & (SHARD_PUBLISH - 1)) == 0) tail.store(written, memory_order_release);
+    }
+
+    void finish(){
+        tail.store(written, memory_order_release);
+        done.store(true, memory_order_release);
+    }
+
+    //hands published entries to "consume" as contiguous runs of the ring
+    template <typename F> void drain(F consume){
+        size_t h = head.load(memory_order_relaxed);
+        for(;;){
+            size_t t = tail.load(memory_order_acquire);
+            if(h == t){
+                if(done.load(memory_order_acquire) && h == tail.load(memory_order_acquire)) return;
+                this_thread::yield();
+                continue;
+            }
+            while(h != t){
+                size_t at = h & (SHARD_RING - 1);
+                size_t count = min(t - h, SHARD_RING - at);
+                consume(&ops[at], &blocks[at], (unsigned)count);
+                h += count;
+            }
+            head.store(h, memory_order_release);
+        }
+    }
+};
+
+void cache::run_sharded(unsigned num_entries, unsigned threads){
+    //by default the thread parsing the trace keeps a hardware thread to itself
+    if(threads == 0){
+        unsigned hardware = thread::hardware_concurrency();
+        threads = hardware > 1 ? hardware - 1 : 0;
+    }
+    if(!plain_lru() || threads == 0){
+        run(num_entries);
+        return;
+    }
+
+    if(threads > c_set) threads = c_set;
+    unsigned setsPerShard = (c_set + threads - 1) / threads;
+    threads = (c_set + setsPerShard - 1) / setsPerShard;
+
+    unsigned long long first_access = number_memory_accesses;
+    vector<shard_ring *> rings;
+    vector<kernel_counts_t> counts(threads, kernel_counts(first_access));
+    for(unsigned t = 0; t < threads; t++) rings.push_back(new shard_ring());
+
+    vector<thread> workers;
+    for(unsigned t = 0; t < threads; t++){
+        shard_ring *ring = rings[t];
+        kernel_counts_t *n = &counts[t];
+        workers.push_back(thread([this, ring, n](){
+            ring->drain([this, n](const char *ops, const long long *blocks, unsigned count){
+                kernel(*this, ops, blocks, count, *n);
+            });
+        }));
+    }
+
+    char op;
+    address_t address;
+    while (trace.next(op, address)){
+        if(op == 'r' || op == 'w'){
+            long long block = address >> blkoffBits;
+            unsigned set = (block & maskSetBits) % c_set;
+            rings[set / setsPerShard]->push(op, block);
+        }
+        number_memory_accesses++;
+        if (num_entries!=0 && (number_memory_accesses-first_access)==num_entries)
+            break;
+    }
+    for(unsigned t = 0; t < threads; t++) rings[t]->finish();
+    for(unsigned t = 0; t < threads; t++) workers[t].join();
+
+    //the lines are already in place; only the counters are merged
+    unsigned long long total = number_memory_accesses;
+    for(unsigned t = 0; t < threads; t++){
+        merge_kernel_counts(counts[t]);
+        delete rings[t];
+    }
+    number_memory_accesses = total;
+}
@@ -0,0 +1,201 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#include "cache.h"
+#include "le_bytes.h"
+#include "mapped_file.h"
+#include <string.h>
+
+//Checkpoints hold the warm state of a cache so later runs can skip the
+//warm-up. A snapshot is a CHECKPOINT_HEADER_SIZE byte header followed by
+//sections that each start on an 8-byte boundary. Every field and array
+//element is little-endian, so a snapshot reads the same on any host:
+//
+//  header      magic "CTRC", version, geometry, policies and victim/miss
+//              cache kind, access count,
+//              trace position, victim/miss cache entries, policy state size,
+//              lines and uncounted warm-up accesses
+//  counters    CHECKPOINT_COUNTERS 64-bit statistics counters
+//  tags        64-bit tag per line
+//  state       state byte per line
+//  LRU         64-bit timestamp per line (LRU only)
+//  sectors     32-bit valid mask, then 32-bit dirty mask, per line (sectored only)
+//  assist      24 bytes per victim/miss cache entry: block, stamp, valid, dirty
+//  policy      replacement policy state (policies other than LRU)
+//
+//Prefetcher tables, MSHRs, the bandwidth model, sampling windows, miss
+//profiles, the miss classifier's shadow cache and TLBs are not saved, so
+//save_checkpoint refuses while any of them is on.
+
+#define CHECKPOINT_MAGIC "CTRC"
+#define CHECKPOINT_VERSION 2
+#define CHECKPOINT_HEADER_SIZE 80
+#define CHECKPOINT_ASSIST_ENTRY 24
+#define CHECKPOINT_COUNTERS 11
+
+static size_t align8(size_t n){
+    return (n + 7) & ~(size_t)7;
+}
+
+//appends a section of "count" values, padded to the next 8-byte boundary
+template <typename T> static void put_section(vector<unsigned char> &out, const T *values, size_t count){
+    put_le_array(out, values, count);
+    out.resize(align8(out.size()), 0);
+}
+
+//reads a section written by put_section; returns the start of the next one
+template <typename T> static const unsigned char *get_section(const unsigned char *in, T *values, size_t count){
+    return in + align8(get_le_array(in, values, count));
+}
+
+bool cache::save_checkpoint(const char *filename){
+    //state the snapshot has no section for would be silently lost on a load
+    if(tlbs || pf || numMshrs || memoryBandwidth > 0 || samplingMode != SAMPLE_NONE || profile || classifier)
+        return false;
+    unsigned lines = c_set * numWays;
+    vector<unsigned char> policyState;
+    if(policy) policy->save(policyState);
+
+    vector<unsigned char> out(CHECKPOINT_HEADER_SIZE, 0);
+    unsigned char *h = &out[0];
+    memcpy(h, CHECKPOINT_MAGIC, 4);
+    put_le(h + 4, CHECKPOINT_VERSION, 4);
+    put_le(h + 8, c_size, 4);
+    put_le(h + 12, numWays, 4);
+    put_le(h + 16, blockSize, 4);
+    put_le(h + 20, numSectors, 4);
+    h[24] = (unsigned char)hitPolicy;
+    h[25] = (unsigned char)missPolicy;
+    h[26] = (unsigned char)replacement;
+    h[27] = (unsigned char)assistKind;
+    put_le(h + 32, number_memory_accesses, 8);
+    put_le(h + 40, trace.tell(), 8);
+    put_le(h + 48, trace.last_address(), 8);
+    put_le(h + 56, assistBuffer.size(), 4);
+    put_le(h + 60, policyState.size(), 4);
+    put_le(h + 64, lines, 4);
+    put_le(h + 72, warmAccesses, 8);
+
+    unsigned long long counters[CHECKPOINT_COUNTERS] = {
+        numRead, numReadMiss, numWrite, numWriteMiss, numEvict, numMemWrite,
+        numSectorMiss, numAssistHits, bytesFill, bytesWriteback, bytesWriteThrough
+    };
+    put_section(out, counters, CHECKPOINT_COUNTERS);
+    put_section(out, &tagArray[0], lines);
+    put_section(out, &stateArray[0], lines);
+    if(!policy) put_section(out, &lruArray[0], lines);
+    if(numSectors > 1){
+        put_section(out, &sectorValid[0], lines);
+        put_section(out, &sectorDirty[0], lines);
+    }
+    for(unsigned i = 0; i < assistBuffer.size(); i++){
+        unsigned char e[CHECKPOINT_ASSIST_ENTRY] = {0};
+        put_le(e, assistBuffer[i].block, 8);
+        put_le(e + 8, assistBuffer[i].stamp, 8);
+        e[16] = assistBuffer[i].valid;
+        e[17] = assistBuffer[i].dirty;
+        put_section(out, e, sizeof(e));
+    }
+    if(!policyState.empty()) put_section(out, &policyState[0], policyState.size());
+
+    FILE *f = fopen(filename, "wb");
+    if(f == NULL) return false;
+    bool ok = (fwrite(&out[0], 1, out.size(), f) == out.size());
+    ok = (fclose(f) == 0) && ok;
+    return ok;
+}
+
+bool cache::load_checkpoint(const char *filename, bool restore_statistics){
+    mapped_file in;
+    if(!in.open(filename)) return false;
+
+    unsigned lines = c_set * numWays;
+    if(in.size() < CHECKPOINT_HEADER_SIZE) return false;
+    const unsigned char *h = (const unsigned char *)in.begin();
+    if(memcmp(h, CHECKPOINT_MAGIC, 4) != 0 || get_le(h + 4, 4) != CHECKPOINT_VERSION) return false;
+    if(get_le(h + 8, 4) != c_size || get_le(h + 12, 4) != numWays || get_le(h + 16, 4) != blockSize ||
+       get_le(h + 20, 4) != numSectors || h[24] != hitPolicy || h[25] != missPolicy ||
+       h[26] != replacement || get_le(h + 56, 4) != assistBuffer.size() || get_le(h + 64, 4) != lines ||
+       (!assistBuffer.empty() && h[27] != assistKind))
+        return false;
+    size_t policySize = get_le(h + 60, 4);
+
+    //every section must be present before anything is overwritten
+    size_t expected = CHECKPOINT_HEADER_SIZE + align8(CHECKPOINT_COUNTERS * 8) + align8(lines * sizeof(tagArray[0]))
+                    + align8(lines) + (policy ? 0 : align8(lines * sizeof(lruArray[0])))
+                    + (numSectors > 1 ? 2 * align8(lines * sizeof(sectorValid[0])) : 0)
+                    + assistBuffer.size() * CHECKPOINT_ASSIST_ENTRY + align8(policySize);
+    if(in.size() != expected) return false;
+
+    const unsigned char *p = h + CHECKPOINT_HEADER_SIZE;
+    const unsigned char *counters = p;
+    p += align8(CHECKPOINT_COUNTERS * 8);
+    const unsigned char *policyState = h + expected - align8(policySize);
+    if(!policy && policySize != 0) return false;
+
+    //the trace must hold the saved position, and is put back if the policy state is rejected
+    unsigned long long position = trace.tell();
+    unsigned long long lastAddress = trace.last_address();
+    if(!trace.seek(get_le(h + 40, 8), get_le(h + 48, 8))) return false;
+    if(policy && !policy->load(policyState, policySize)){
+        trace.seek(position, lastAddress);
+        return false;
+    }
+
+    p = get_section(p, &tagArray[0], lines);
+    p = get_section(p, &stateArray[0], lines);
+    if(!policy) p = get_section(p, &lruArray[0], lines);
+    if(numSectors > 1){
+        p = get_section(p, &sectorValid[0], lines);
+        p = get_section(p, &sectorDirty[0], lines);
+    }
+    for(unsigned i = 0; i < assistBuffer.size(); i++, p += CHECKPOINT_ASSIST_ENTRY){
+        assistBuffer[i].block = (long long)get_le(p, 8);
+        assistBuffer[i].stamp = get_le(p + 8, 8);
+        assistBuffer[i].valid = p[16] != 0;
+        assistBuffer[i].dirty = p[17] != 0;
+    }
+    //prefetched lines are taken to have arrived
+    if(!readyArray.empty()) readyArray.assign(readyArray.size(), 0);
+
+    //the access count is the LRU clock, so it carries over even when the counters do not
+    number_memory_accesses = get_le(h + 32, 8);
+    warmAccesses = restore_statistics ? get_le(h + 72, 8) : number_memory_accesses;
+    if(restore_statistics){
+        numRead = get_le(counters, 8);
+        numReadMiss = get_le(counters + 8, 8);
+        numWrite = get_le(counters + 16, 8);
+        numWriteMiss = get_le(counters + 24, 8);
+        numEvict = get_le(counters + 32, 8);
+        numMemWrite = get_le(counters + 40, 8);
+        numSectorMiss = get_le(counters + 48, 8);
+        numAssistHits = get_le(counters + 56, 8);
+        bytesFill = get_le(counters + 64, 8);
+        bytesWriteback = get_le(counters + 72, 8);
+        bytesWriteThrough = get_le(counters + 80, 8);
+    }
+    else{
+        //whatever ran before the load is part of the warm-up too
+        numRead = 0;
+        numReadMiss = 0;
+        numWrite = 0;
+        numWriteMiss = 0;
+        numEvict = 0;
+        numMemWrite = 0;
+        numSectorMiss = 0;
+        numAssistHits = 0;
+        bytesFill = 0;
+        bytesWriteback = 0;
+        bytesWriteThrough = 0;
+        numPrefetch = 0;
+        numPrefetchUseful = 0;
+        numPrefetchLate = 0;
+        numPrefetchPolluting = 0;
+        numPrefetchUnused = 0;
+        stallCycles = 0;
+        translationCycles = 0;
+    }
+    return true;
+}
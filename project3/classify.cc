@@ -0,0 +1,143 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#include "classify.h"
+
+using namespace std;
+
+#define NO_NODE 0xFFFFFFFF
+#define SEEN_EMPTY (-1LL - 0x7FFFFFFFFFFFFFFFLL)   //free slot of the seen set
+#define SEEN_SLOTS 65536                            //initial size of the seen set (power of two)
+
+static unsigned hash_block(long long b){
+    return (unsigned)(((unsigned long long)b * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+miss_classifier::miss_classifier(unsigned lines){
+    if(lines == 0) lines = 1;
+    block.assign(lines, 0);
+    prev.assign(lines, NO_NODE);
+    next.assign(lines, NO_NODE);
+    head = tail = NO_NODE;
+    used = 0;
+
+    unsigned slots = 2;
+    while(slots < 2 * lines) slots *= 2;
+    index.assign(slots, 0);
+    mask = slots - 1;
+
+    seen.assign(SEEN_SLOTS, SEEN_EMPTY);
+    seenMask = SEEN_SLOTS - 1;
+    seenCount = 0;
+    seenEmptyBlock = false;
+
+    numCompulsory = 0;
+    numCapacity = 0;
+    numConflict = 0;
+}
+
+bool miss_classifier::first_touch(long long b){
+    if(b == SEEN_EMPTY){
+        bool first = !seenEmptyBlock;
+        seenEmptyBlock = true;
+        return first;
+    }
+    unsigned s = hash_block(b) & seenMask;
+    while(seen[s] != SEEN_EMPTY){
+        if(seen[s] == b) return false;
+        s = (s + 1) & seenMask;
+    }
+    seen[s] = b;
+    if(2 * ++seenCount > seen.size()){
+        vector<long long> old;
+        old.swap(seen);
+        seen.assign(old.size() * 2, SEEN_EMPTY);
+        seenMask = seen.size() - 1;
+        for(unsigned i = 0; i < old.size(); i++){
+            if(old[i] == SEEN_EMPTY) continue;
+            unsigned t = hash_block(old[i]) & seenMask;
+            while(seen[t] != SEEN_EMPTY) t = (t + 1) & seenMask;
+            seen[t] = old[i];
+        }
+    }
+    return true;
+}
+
+unsigned miss_classifier::find(long long b) const{
+    unsigned s = hash_block(b) & mask;
+    while(index[s] != 0 && block[index[s] - 1] != b) s = (s + 1) & mask;
+    return s;
+}
+
+void miss_classifier::erase(unsigned slot){
+    //backward-shift deletion: pull later entries of the probe run into the hole
+    unsigned hole = slot;
+    unsigned s = (slot + 1) & mask;
+    while(index[s] != 0){
+        unsigned home = hash_block(block[index[s] - 1]) & mask;
+        //the entry may move if its home is not in the cyclic range (hole, s]
+        if(((s - home) & mask) >= ((s - hole) & mask)){
+            index[hole] = index[s];
+            hole = s;
+        }
+        s = (s + 1) & mask;
+    }
+    index[hole] = 0;
+}
+
+void miss_classifier::unlink(unsigned node){
+    if(prev[node] != NO_NODE) next[prev[node]] = next[node];
+    else head = next[node];
+    if(next[node] != NO_NODE) prev[next[node]] = prev[node];
+    else tail = prev[node];
+}
+
+void miss_classifier::push_front(unsigned node){
+    prev[node] = NO_NODE;
+    next[node] = head;
+    if(head != NO_NODE) prev[head] = node;
+    head = node;
+    if(tail == NO_NODE) tail = node;
+}
+
+miss_class_t miss_classifier::classify(long long b, bool miss, bool allocate){
+    bool first = first_touch(b);
+
+    unsigned slot = find(b);
+    bool shadowHit = (index[slot] != 0);
+    if(shadowHit){
+        unsigned node = index[slot] - 1;
+        unlink(node);
+        push_front(node);
+    }
+    else if(allocate || !miss){
+        unsigned node;
+        if(used < block.size()){
+            node = used++;
+        }
+        else{
+            //reuse the least recently used node
+            node = tail;
+            erase(find(block[node]));
+            unlink(node);
+            slot = find(b);
+        }
+        block[node] = b;
+        index[slot] = node + 1;
+        push_front(node);
+    }
+
+    if(!miss) return MISS_NONE;
+    if(first){
+        numCompulsory++;
+        return MISS_COMPULSORY;
+    }
+    if(!shadowHit){
+        numCapacity++;
+        return MISS_CAPACITY;
+    }
+    numConflict++;
+    return MISS_CONFLICT;
+}
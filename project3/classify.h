@@ -0,0 +1,62 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#ifndef CLASSIFY_H_
+#define CLASSIFY_H_
+
+#include <vector>
+
+typedef enum {MISS_NONE, MISS_COMPULSORY, MISS_CAPACITY, MISS_CONFLICT} miss_class_t;
+
+//Sorts the misses of a cache into the three Cs. A miss on a block never seen
+//before is compulsory; otherwise it is a capacity miss if a fully-associative
+//LRU cache with the same number of lines would also have missed, and a
+//conflict miss if that cache would have hit.
+//
+//The shadow cache is a node array threaded into an LRU list (most recent at
+//the head) and indexed by an open-addressing hash table of block -> node,
+//sized to at most half full and kept probe-friendly by backward-shift
+//deletion, so each access costs one lookup and a few pointer updates.
+//First touches are found in a second open-addressing table of every block seen.
+class miss_classifier{
+    //shadow cache
+    std::vector<long long> block;
+    std::vector<unsigned> prev;
+    std::vector<unsigned> next;
+    unsigned head;              //most recently used node
+    unsigned tail;              //least recently used node
+    unsigned used;              //nodes in the list
+
+    //hash index: node + 1 per slot, 0 when empty
+    std::vector<unsigned> index;
+    unsigned mask;
+
+    //blocks touched so far: open-addressing set that doubles at half load, with
+    //SEEN_EMPTY marking free slots (the block equal to it is tracked on its own)
+    std::vector<long long> seen;
+    unsigned seenMask;
+    unsigned seenCount;
+    bool seenEmptyBlock;
+
+    bool first_touch(long long b);      //adds "b" to the seen set; returns whether it is new
+
+    unsigned find(long long b) const;   //slot of "b", or of the empty slot ending its probe
+    void erase(unsigned slot);
+    void unlink(unsigned node);
+    void push_front(unsigned node);
+
+public:
+    unsigned long long numCompulsory;
+    unsigned long long numCapacity;
+    unsigned long long numConflict;
+
+    miss_classifier(unsigned lines);
+
+    // accounts one demand access; "miss" is what the real cache did and "allocate" whether
+    // it brings the block in on a miss; returns the class of the miss (MISS_NONE on a hit)
+    miss_class_t classify(long long b, bool miss, bool allocate);
+};
+
+#endif /*CLASSIFY_H_*/
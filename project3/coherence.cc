@@ -0,0 +1,258 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#include "coherence.h"
+#include <string.h>
+
+coherent_system::coherent_system(unsigned num_cores, unsigned cache_size, unsigned cache_associativity,
+                                 unsigned cache_line_size, unsigned cache_hit_time, unsigned memory_latency,
+                                 unsigned transfer_latency, unsigned address_width,
+                                 coherence_protocol_t coherence_protocol, interconnect_t coherence_interconnect){
+    protocol = coherence_protocol;
+    interconnect = coherence_interconnect;
+    memoryLatency = memory_latency;
+    transferLatency = transfer_latency;
+    busTransactions = 0;
+    snoopLookups = 0;
+    directoryMessages = 0;
+    memReads = 0;
+    memWrites = 0;
+    number_memory_accesses = 0;
+
+    if(num_cores > MAX_CORES) num_cores = MAX_CORES;
+    core_stats_t empty;
+    memset(&empty, 0, sizeof(empty));
+    for(unsigned i = 0; i < num_cores; i++){
+        cores.push_back(new cache(cache_size, cache_associativity, cache_line_size, WRITE_BACK, WRITE_ALLOCATE,
+                                  cache_hit_time, memory_latency, address_width));
+        stats.push_back(empty);
+        lost.push_back(vector<unsigned char>(cores[i]->c_set * cores[i]->numWays, 0));
+    }
+}
+
+coherent_system::~coherent_system(){
+    for(unsigned i = 0; i < cores.size(); i++) delete cores[i];
+}
+
+bool coherent_system::load_trace(const char *filename, trace_format_t format){
+    return trace.open(filename, format);
+}
+
+void coherent_system::run(unsigned num_entries){
+    unsigned long long first_access = number_memory_accesses;
+    unsigned core;
+    char op;
+    address_t address;
+
+    while(trace.next(core, op, address)){
+        if((op == 'r' || op == 'w') && core < cores.size()) access(core, op, address);
+        else number_memory_accesses++;
+        if(num_entries != 0 && (number_memory_accesses - first_access) == num_entries)
+            break;
+    }
+}
+
+unsigned coherent_system::find(unsigned core, long long block){
+    cache *c = cores[core];
+    return c->findLine(c->setBase((block & c->maskSetBits) % c->c_set), block >> c->setBits);
+}
+
+unsigned long long coherent_system::holders(unsigned core, long long block){
+    unsigned long long mask = 0;
+    busTransactions++;
+    if(interconnect == SNOOPING_BUS){
+        for(unsigned i = 0; i < cores.size(); i++){
+            if(i == core) continue;
+            snoopLookups++;
+            if(find(i, block) != NO_LINE) mask |= 1ULL << i;
+        }
+    }
+    else{
+        //the request to the home directory
+        directoryMessages++;
+        std::unordered_map<long long, unsigned long long>::iterator it = sharers.find(block);
+        if(it != sharers.end()) mask = it->second & ~(1ULL << core);
+    }
+    return mask;
+}
+
+void coherent_system::invalidate(unsigned core, long long block, unsigned line){
+    cores[core]->stateArray[line] = 0;
+    stats[core].invalidations++;
+    lost[core][line] = 1;
+    if(interconnect == DIRECTORY){
+        drop_sharer(core, block);
+        //invalidation and acknowledgement
+        directoryMessages += 2;
+    }
+}
+
+void coherent_system::drop_sharer(unsigned core, long long block){
+    std::unordered_map<long long, unsigned long long>::iterator it = sharers.find(block);
+    if(it != sharers.end()){
+        it->second &= ~(1ULL << core);
+        if(it->second == 0) sharers.erase(it);
+    }
+}
+
+unsigned coherent_system::fill(unsigned core, long long block){
+    cache *c = cores[core];
+    long long setIndex = (block & c->maskSetBits) % c->c_set;
+    c->outcome.evicted = false;
+    unsigned line = c->allocate(setIndex, block >> c->setBits);
+
+    const access_outcome_t &o = c->outcome;
+    if(o.evicted){
+        long long victim = o.victim >> c->blkoffBits;
+        if(o.victimDirty){
+            stats[core].writebacks++;
+            memWrites++;
+        }
+        if(interconnect == DIRECTORY){
+            //evictions are reported to the directory (clean ones without a message),
+            //so the sharer masks stay exact
+            drop_sharer(core, victim);
+        }
+    }
+    if(interconnect == DIRECTORY) sharers[block] |= 1ULL << core;
+    lost[core][line] = 0;
+    return line;
+}
+
+unsigned coherent_system::access(unsigned core, char op, address_t address){
+    if(core >= cores.size()) return 0;
+    cache *c = cores[core];
+    core_stats_t &s = stats[core];
+    number_memory_accesses++;
+    c->number_memory_accesses++;
+
+    long long block = address >> c->blkoffBits;
+    long long setIndex = (block & c->maskSetBits) % c->c_set;
+    unsigned line = c->findLine(c->setBase(setIndex), block >> c->setBits);
+    unsigned latency = c->hitTime;
+    if(op == 'w'){
+        s.writes++;
+        c->numWrite++;
+    }
+    else{
+        s.reads++;
+        c->numRead++;
+    }
+
+    if(line != NO_LINE){
+        c->touch(setIndex, line);
+        if(op == 'w'){
+            //S or O: the other copies have to go before the write (E and M write silently)
+            if(c->stateArray[line] & LINE_SHARED){
+                s.upgrades++;
+                latency += transferLatency;
+                unsigned long long others = holders(core, block);
+                for(unsigned i = 0; i < cores.size(); i++){
+                    if(others & (1ULL << i)) invalidate(i, block, find(i, block));
+                }
+                c->stateArray[line] &= ~LINE_SHARED;
+            }
+            c->stateArray[line] |= LINE_DIRTY;
+        }
+        s.latency += latency;
+        return latency;
+    }
+
+    s.misses++;
+    if(op == 'w') c->numWriteMiss++;
+    else c->numReadMiss++;
+    //the block was invalidated here and its line not reused since
+    unsigned base = c->setBase(setIndex);
+    for(unsigned i = base; i < base + c->numWays; i++){
+        if(lost[core][i] && c->tagArray[i] == (block >> c->setBits)){
+            lost[core][i] = 0;
+            s.coherenceMisses++;
+            break;
+        }
+    }
+
+    //read (for ownership, on a write) from the other caches
+    unsigned long long others = holders(core, block);
+    bool supplied = false;
+    for(unsigned i = 0; i < cores.size(); i++){
+        if(!(others & (1ULL << i))) continue;
+        unsigned otherLine = find(i, block);
+        unsigned char &state = cores[i]->stateArray[otherLine];
+        bool dirty = (state & LINE_DIRTY) != 0;
+
+        //at most one cache holds a dirty copy, and it supplies the data
+        if(dirty){
+            stats[i].interventions++;
+            supplied = true;
+        }
+        if(op == 'w'){
+            invalidate(i, block, otherLine);
+            continue;
+        }
+        if(interconnect == DIRECTORY && (dirty || !(state & LINE_SHARED))){
+            //forward (or downgrade) and reply
+            directoryMessages += 2;
+        }
+        if(dirty && protocol != MOESI){
+            //M -> S writes the line back; MOESI keeps it dirty as O
+            state &= ~LINE_DIRTY;
+            stats[i].writebacks++;
+            memWrites++;
+        }
+        state |= LINE_SHARED;
+    }
+    if(supplied){
+        latency += transferLatency;
+    }
+    else{
+        latency += memoryLatency;
+        memReads++;
+    }
+
+    line = fill(core, block);
+    if(op == 'w') c->stateArray[line] |= LINE_DIRTY;
+    else if(others != 0 || protocol == MSI) c->stateArray[line] |= LINE_SHARED;
+
+    s.latency += latency;
+    return latency;
+}
+
+void coherent_system::print_configuration(){
+    cout << "COHERENT SYSTEM" << endl;
+    cout << "cores = " << dec << cores.size() << endl;
+    cout << "protocol = " << (protocol == MSI ? "MSI" : protocol == MESI ? "MESI" : "MOESI") << endl;
+    cout << "interconnect = " << (interconnect == SNOOPING_BUS ? "snooping bus" : "directory") << endl;
+    cout << "memory latency = " << dec << memoryLatency << " CLK" << endl;
+    cout << "cache-to-cache latency = " << dec << transferLatency << " CLK" << endl;
+    if(!cores.empty()){
+        cout << endl << "PRIVATE ";
+        cores[0]->print_configuration();
+    }
+}
+
+void coherent_system::print_statistics(){
+    cout << "COHERENCE STATISTICS" << endl;
+    cout << "memory accesses = " << dec << number_memory_accesses << endl;
+    cout << "bus transactions = " << busTransactions << endl;
+    if(interconnect == SNOOPING_BUS) cout << "snoop lookups = " << snoopLookups << endl;
+    else cout << "directory messages = " << directoryMessages << endl;
+    cout << "memory reads = " << memReads << endl;
+    cout << "memory writes = " << memWrites << endl;
+    for(unsigned i = 0; i < cores.size(); i++){
+        const core_stats_t &s = stats[i];
+        unsigned long long accesses = s.reads + s.writes;
+        cout << endl << "CORE " << i << endl;
+        cout << "reads = " << s.reads << endl;
+        cout << "writes = " << s.writes << endl;
+        cout << "misses = " << s.misses << endl;
+        cout << "miss rate = " << (accesses ? double(s.misses) / double(accesses) : 0.0) << endl;
+        cout << "coherence misses = " << s.coherenceMisses << endl;
+        cout << "upgrades = " << s.upgrades << endl;
+        cout << "invalidations = " << s.invalidations << endl;
+        cout << "interventions = " << s.interventions << endl;
+        cout << "writebacks = " << s.writebacks << endl;
+        cout << "average access time = " << (accesses ? double(s.latency) / double(accesses) : 0.0) << endl;
+    }
+}
@@ -0,0 +1,128 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#ifndef COHERENCE_H_
+#define COHERENCE_H_
+
+#include <unordered_map>
+#include "cache.h"
+
+#define MAX_CORES 64    //cores a sharer mask can hold
+
+typedef enum {MSI, MESI, MOESI} coherence_protocol_t;
+
+typedef enum {SNOOPING_BUS, DIRECTORY} interconnect_t;
+
+//per-core statistics kept by the coherent system
+typedef struct{
+    unsigned long long reads;
+    unsigned long long writes;
+    unsigned long long misses;
+    unsigned long long coherenceMisses;     // misses on blocks another core's write had invalidated here
+    unsigned long long upgrades;            // writes to a shared line, which invalidate the other copies
+    unsigned long long invalidations;       // lines invalidated by other cores
+    unsigned long long interventions;       // dirty lines supplied to another core
+    unsigned long long writebacks;          // dirty lines written to memory
+    unsigned long long latency;             // total cycles spent on this core's accesses
+} core_stats_t;
+
+//Private write-back caches, one per core, kept coherent over a snooping bus
+//or a directory. Line states are encoded in the cache state bits:
+//
+//  M: valid, dirty            E: valid             I: not valid
+//  O: valid, dirty, shared    S: valid, shared
+//
+//MSI fills every read as S, MESI fills a read nobody else holds as E, and
+//MOESI lets the supplier of a dirty line keep it as O instead of writing it
+//back. A dirty (M or O) copy is sent cache to cache; clean data comes from
+//memory. Both interconnects reach the same states: the bus probes every other
+//cache on each transaction, while the directory keeps a sharer mask per block
+//and only messages the caches involved. Sharers are tracked in 64-bit masks,
+//so a system has at most MAX_CORES cores.
+//
+//An invalidated line keeps its tag, and a later miss on that tag counts as a
+//coherence miss unless the line has been refilled in between.
+class coherent_system{
+    vector<cache *> cores;
+    vector<core_stats_t> stats;
+    coherence_protocol_t protocol;
+    interconnect_t interconnect;
+    unsigned memoryLatency;
+    unsigned transferLatency;
+    unsigned long long busTransactions;
+    unsigned long long snoopLookups;
+    unsigned long long directoryMessages;
+    unsigned long long memReads;
+    unsigned long long memWrites;
+    unsigned long long number_memory_accesses;
+
+    //per block, the cores holding it (directory only)
+    std::unordered_map<long long, unsigned long long> sharers;
+
+    //per core and line, set while the line holds the tag of a block another core invalidated
+    vector<vector<unsigned char> > lost;
+
+    trace_reader trace;
+
+    coherent_system(const coherent_system &);
+    coherent_system &operator=(const coherent_system &);
+
+    // the line of "core" holding "block", or NO_LINE
+    unsigned find(unsigned core, long long block);
+
+    // starts a bus transaction or directory request for "block"; returns the other cores holding it
+    unsigned long long holders(unsigned core, long long block);
+
+    // removes "block" from "core" after another core's write
+    void invalidate(unsigned core, long long block, unsigned line);
+
+    // clears "core" from the sharer mask of "block", dropping the entry once no core holds the block
+    void drop_sharer(unsigned core, long long block);
+
+    // brings "block" into "core", writing back a dirty victim; returns its line
+    unsigned fill(unsigned core, long long block);
+
+public:
+    coherent_system(unsigned num_cores,             // at most MAX_CORES (larger counts are clamped to it)
+                    unsigned cache_size,            // size of each private cache (in bytes)
+                    unsigned cache_associativity,
+                    unsigned cache_line_size,       // (in bytes)
+                    unsigned cache_hit_time,        // (in clock cycles)
+                    unsigned memory_latency,        // main memory access time (in clock cycles)
+                    unsigned transfer_latency,      // cache-to-cache transfer or upgrade time (in clock cycles)
+                    unsigned address_width,         // number of bits in memory address
+                    coherence_protocol_t coherence_protocol=MESI,
+                    interconnect_t coherence_interconnect=SNOOPING_BUS
+    );
+
+    // deletes the caches
+    ~coherent_system();
+
+    // loads a multi-core trace (with name "filename"), whose entries start with a core ID
+    // returns false if the trace cannot be opened or is a truncated or unsupported binary trace
+    bool load_trace(const char *filename, trace_format_t format=TRACE_AUTO);
+
+    // processes "num_memory_accesses" memory accesses from the trace (0 = to completion);
+    // entries of cores the system does not have are skipped
+    void run(unsigned num_memory_accesses=0);
+
+    // processes one access ('r' or 'w') of "core"; returns its latency (in clock cycles),
+    // or 0 for a core the system does not have
+    unsigned access(unsigned core, char op, address_t address);
+
+    // returns the statistics of "core" (all 0 for a core the system does not have)
+    core_stats_t core_statistics(unsigned core) const { return core < stats.size() ? stats[core] : core_stats_t(); }
+
+    // blocks the directory holds a sharer mask for (0 on a snooping bus)
+    size_t directory_entries() const { return sharers.size(); }
+
+    // prints the protocol, interconnect and private cache configuration
+    void print_configuration();
+
+    // prints system-wide and per-core statistics
+    void print_statistics();
+};
+
+#endif /*COHERENCE_H_*/
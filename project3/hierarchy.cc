@@ -0,0 +1,203 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#include "hierarchy.h"
+#include <string.h>
+
+cache_hierarchy::cache_hierarchy(inclusion_policy_t inclusion_policy, unsigned memory_latency){
+    inclusion = inclusion_policy;
+    memoryLatency = memory_latency;
+    memReads = 0;
+    memWrites = 0;
+    number_memory_accesses = 0;
+}
+
+cache_hierarchy::~cache_hierarchy(){
+    for(unsigned i = 0; i < levels.size(); i++) delete levels[i];
+}
+
+void cache_hierarchy::add_level(cache *level){
+    level_stats_t empty;
+    memset(&empty, 0, sizeof(empty));
+    levels.push_back(level);
+    stats.push_back(empty);
+}
+
+bool cache_hierarchy::load_trace(const char *filename, trace_format_t format){
+    return trace.open(filename, format);
+}
+
+void cache_hierarchy::run(unsigned num_entries){
+    unsigned long long first_access = number_memory_accesses;
+    char op;
+    address_t address;
+
+    while(trace.next(op, address)){
+        if(op == 'r' || op == 'w') access(op, address);
+        else number_memory_accesses++;
+        if(num_entries != 0 && (number_memory_accesses - first_access) == num_entries)
+            break;
+    }
+}
+
+unsigned cache_hierarchy::access(char op, address_t address){
+    bool dirty;
+    number_memory_accesses++;
+    return lookup(0, op, address, dirty);
+}
+
+unsigned cache_hierarchy::lookup(unsigned i, char op, address_t address, bool &dirty){
+    dirty = false;
+    if(i == levels.size()){
+        if(op == 'w') memWrites++;
+        else memReads++;
+        return memoryLatency;
+    }
+
+    cache *c = levels[i];
+    level_stats_t &s = stats[i];
+    unsigned latency = c->hitTime;
+    s.accesses++;
+    if(op == 'w') s.writes++;
+    else s.reads++;
+
+    if(inclusion == EXCLUSIVE && i > 0){
+        //a hit hands the block up and frees the line; a miss is not filled here
+        c->number_memory_accesses++;
+        if(!c->extract(address, dirty)){
+            s.misses++;
+            latency += lookup(i + 1, op, address, dirty);
+        }
+        s.latency += latency;
+        return latency;
+    }
+
+    c->access_block(op, address >> c->blkoffBits);
+    c->number_memory_accesses++;
+    access_outcome_t o = c->outcome;
+
+    if(o.evicted) victim(i, o.victim, o.victimDirty);
+    if(!o.hit){
+        s.misses++;
+        if(o.filled){
+            bool fillDirty;
+            latency += lookup(i + 1, 'r', address, fillDirty);
+            if(fillDirty) c->insert_block(address, true);
+        }
+    }
+    if(op == 'w' && (c->hitPolicy == WRITE_THROUGH || (!o.hit && !o.filled))){
+        unsigned below = write_down(i + 1, address);
+        //like the single-level model, only write misses wait for the level below
+        if(!o.hit && !o.filled) latency += below;
+    }
+
+    s.latency += latency;
+    return latency;
+}
+
+unsigned cache_hierarchy::write_down(unsigned i, address_t address){
+    if(inclusion != EXCLUSIVE){
+        bool dirty;
+        return lookup(i, 'w', address, dirty);
+    }
+
+    //exclusive levels are not filled by writes: update the one copy, wherever it is
+    unsigned latency = 0;
+    for(; i < levels.size(); i++){
+        latency += levels[i]->hitTime;
+        if(levels[i]->holds(address)){
+            levels[i]->insert_block(address, true);
+            stats[i].blocksIn++;
+            return latency;
+        }
+    }
+    memWrites++;
+    return latency + memoryLatency;
+}
+
+void cache_hierarchy::victim(unsigned i, address_t block, bool dirty){
+    if(inclusion == EXCLUSIVE){
+        if(i + 1 == levels.size()){
+            if(dirty){
+                stats[i].writebacks++;
+                memWrites++;
+            }
+            return;
+        }
+        //every victim, clean or dirty, moves down one level
+        cache *below = levels[i + 1];
+        below->insert_block(block, dirty);
+        below->number_memory_accesses++;
+        stats[i + 1].blocksIn++;
+        if(dirty) stats[i].writebacks++;
+        access_outcome_t o = below->outcome;
+        if(o.evicted) victim(i + 1, o.victim, o.victimDirty);
+        return;
+    }
+
+    if(inclusion == INCLUSIVE){
+        for(unsigned j = 0; j < i; j++){
+            bool upperDirty;
+            stats[j].backInvalidations += levels[j]->invalidate_range(block, levels[i]->blockSize, upperDirty);
+            dirty = dirty || upperDirty;
+        }
+    }
+    if(dirty){
+        stats[i].writebacks++;
+        writeback(i + 1, block);
+    }
+}
+
+void cache_hierarchy::writeback(unsigned i, address_t block){
+    if(i == levels.size()){
+        memWrites++;
+        return;
+    }
+
+    cache *c = levels[i];
+    bool through = (c->hitPolicy == WRITE_THROUGH);
+    stats[i].blocksIn++;
+    c->insert_block(block, !through);
+    c->number_memory_accesses++;
+    access_outcome_t o = c->outcome;
+    if(o.evicted) victim(i, o.victim, o.victimDirty);
+    if(through) writeback(i + 1, block);
+}
+
+void cache_hierarchy::print_configuration(){
+    cout << "CACHE HIERARCHY" << endl;
+    cout << "inclusion policy = ";
+    switch(inclusion){
+        case INCLUSIVE:     cout << "inclusive" << endl; break;
+        case EXCLUSIVE:     cout << "exclusive" << endl; break;
+        case NON_INCLUSIVE: cout << "non-inclusive" << endl; break;
+    }
+    cout << "memory latency = " << dec << memoryLatency << " CLK" << endl;
+    for(unsigned i = 0; i < levels.size(); i++){
+        cout << endl << "L" << i + 1 << " ";
+        levels[i]->print_configuration();
+    }
+}
+
+void cache_hierarchy::print_statistics(){
+    cout << "HIERARCHY STATISTICS" << endl;
+    cout << "memory accesses = " << dec << number_memory_accesses << endl;
+    for(unsigned i = 0; i < levels.size(); i++){
+        const level_stats_t &s = stats[i];
+        cout << endl << "L" << i + 1 << endl;
+        cout << "accesses = " << s.accesses << endl;
+        cout << "reads = " << s.reads << endl;
+        cout << "writes = " << s.writes << endl;
+        cout << "misses = " << s.misses << endl;
+        cout << "local miss rate = " << (s.accesses ? double(s.misses) / double(s.accesses) : 0.0) << endl;
+        cout << (inclusion == EXCLUSIVE ? "victims in = " : "writebacks in = ") << s.blocksIn << endl;
+        cout << "writebacks out = " << s.writebacks << endl;
+        if(inclusion == INCLUSIVE) cout << "back-invalidations = " << s.backInvalidations << endl;
+        cout << "average access time = " << (s.accesses ? double(s.latency) / double(s.accesses) : 0.0) << endl;
+    }
+    cout << endl << "MEMORY" << endl;
+    cout << "reads = " << memReads << endl;
+    cout << "writes = " << memWrites << endl;
+}
@@ -0,0 +1,97 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#ifndef HIERARCHY_H_
+#define HIERARCHY_H_
+
+#include "cache.h"
+
+typedef enum {INCLUSIVE, EXCLUSIVE, NON_INCLUSIVE} inclusion_policy_t;
+
+//per-level statistics kept by the hierarchy
+typedef struct{
+    unsigned long long accesses;            // demand lookups from the level above (or the CPU)
+    unsigned long long reads;
+    unsigned long long writes;
+    unsigned long long misses;
+    unsigned long long blocksIn;            // writebacks (or, when exclusive, victims) from above
+    unsigned long long writebacks;          // dirty blocks sent below
+    unsigned long long backInvalidations;   // lines removed to keep the level below inclusive
+    unsigned long long latency;             // total cycles spent on demand lookups, including levels below
+} level_stats_t;
+
+//A stack of caches, L1 first, in front of main memory. Misses, write-through
+//traffic and dirty victims of a level become accesses of the next one, so the
+//average access time of every level is rolled up from the real latencies
+//below it instead of a fixed miss penalty.
+//
+//INCLUSIVE:     a block evicted from a level is back-invalidated in every level above.
+//EXCLUSIVE:     a block lives in one level only; lower levels are filled by victims of
+//               the level above and hand blocks up on a hit (write-back levels assumed).
+//NON_INCLUSIVE: lower levels are filled on misses and by writebacks, with no back-invalidation.
+//
+//Line sizes must not shrink going down, and an exclusive hierarchy needs the
+//same line size at every level. Every block handed to a level advances that
+//level's access count, which doubles as its LRU clock; the hierarchy reports
+//its own per-level statistics rather than the caches' counters.
+class cache_hierarchy{
+    vector<cache *> levels;
+    vector<level_stats_t> stats;
+    inclusion_policy_t inclusion;
+    unsigned memoryLatency;
+    unsigned long long memReads;
+    unsigned long long memWrites;
+    unsigned long long number_memory_accesses;
+
+    trace_reader trace;
+
+    cache_hierarchy(const cache_hierarchy &);
+    cache_hierarchy &operator=(const cache_hierarchy &);
+
+    // demand lookup of level "i" (levels.size() is memory); returns its latency
+    // and reports whether the block came up dirty from an exclusive level
+    unsigned lookup(unsigned i, char op, address_t address, bool &dirty);
+
+    // deals with a block that level "i" just replaced
+    void victim(unsigned i, address_t block, bool dirty);
+
+    // hands a dirty block to level "i" (levels.size() is memory)
+    void writeback(unsigned i, address_t block);
+
+    // sends a write-through or no-write-allocate write below level "i - 1"; returns its latency
+    unsigned write_down(unsigned i, address_t address);
+
+public:
+    cache_hierarchy(inclusion_policy_t inclusion_policy,
+                    unsigned memory_latency     // main memory access time (in clock cycles)
+    );
+
+    // deletes the levels
+    ~cache_hierarchy();
+
+    // appends a level below the current last one; the hierarchy takes ownership
+    void add_level(cache *level);
+
+    // loads the trace file (with name "filename") so that it can be used by the "run" function
+    // returns false if the trace cannot be opened or is a truncated or unsupported binary trace
+    bool load_trace(const char *filename, trace_format_t format=TRACE_AUTO);
+
+    // processes "num_memory_accesses" memory accesses from the trace (0 = to completion)
+    void run(unsigned num_memory_accesses=0);
+
+    // processes one CPU access ('r' or 'w'); returns its latency (in clock cycles)
+    unsigned access(char op, address_t address);
+
+    // returns the statistics of level "i" (L1 is 0; all 0 for a level the hierarchy does not have)
+    level_stats_t level_statistics(unsigned i) const { return i < stats.size() ? stats[i] : level_stats_t(); }
+
+    // prints the configuration of every level
+    void print_configuration();
+
+    // prints per-level statistics and average memory access times
+    void print_statistics();
+};
+
+#endif /*HIERARCHY_H_*/
@@ -0,0 +1,66 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#include <string.h>
+#include "interval.h"
+#include "le_bytes.h"
+
+#define INTERVAL_BUFFER (1 << 20)
+
+interval_log::interval_log(){
+    out = NULL;
+    format = INTERVAL_CSV;
+}
+
+interval_log::~interval_log(){
+    close();
+}
+
+bool interval_log::open(const char *filename, interval_format_t log_format, unsigned long long interval){
+    close();
+    out = fopen(filename, log_format == INTERVAL_BINARY ? "wb" : "w");
+    if(out == NULL) return false;
+    setvbuf(out, NULL, _IOFBF, INTERVAL_BUFFER);
+    format = log_format;
+
+    if(format == INTERVAL_BINARY){
+        unsigned char header[INTERVAL_HEADER_SIZE];
+        memcpy(header, INTERVAL_MAGIC, 4);
+        put_le(header + 4, INTERVAL_VERSION, 4);
+        put_le(header + 8, interval, 8);
+        fwrite(header, 1, INTERVAL_HEADER_SIZE, out);
+    }
+    else{
+        fputs("access,reads,read_misses,writes,write_misses,miss_rate,evictions,memory_writes\n", out);
+    }
+    return true;
+}
+
+void interval_log::write(const interval_sample_t &s){
+    if(format == INTERVAL_BINARY){
+        unsigned char record[INTERVAL_FIELDS * 8];
+        put_le(record, s.end, 8);
+        put_le(record + 8, s.reads, 8);
+        put_le(record + 16, s.readMisses, 8);
+        put_le(record + 24, s.writes, 8);
+        put_le(record + 32, s.writeMisses, 8);
+        put_le(record + 40, s.evictions, 8);
+        put_le(record + 48, s.memoryWrites, 8);
+        fwrite(record, 1, sizeof(record), out);
+    }
+    else{
+        unsigned long long accesses = s.reads + s.writes;
+        double missRate = accesses ? double(s.readMisses + s.writeMisses) / accesses : 0.0;
+        fprintf(out, "%llu,%llu,%llu,%llu,%llu,%.6f,%llu,%llu\n", s.end, s.reads, s.readMisses,
+                s.writes, s.writeMisses, missRate, s.evictions, s.memoryWrites);
+    }
+}
+
+void interval_log::close(){
+    if(out != NULL){
+        fclose(out);
+        out = NULL;
+    }
+}
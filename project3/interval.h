@@ -0,0 +1,59 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#ifndef INTERVAL_H_
+#define INTERVAL_H_
+
+#include <stdio.h>
+
+typedef enum {INTERVAL_CSV, INTERVAL_BINARY} interval_format_t;
+
+//Binary interval logs start with an INTERVAL_HEADER_SIZE byte header: the magic
+//"CTRI", a little-endian 32-bit version and the 64-bit interval length.
+//Each interval is then INTERVAL_FIELDS little-endian 64-bit values, in the
+//order of the CSV columns below (without the miss rate, which follows from them).
+#define INTERVAL_MAGIC "CTRI"
+#define INTERVAL_VERSION 1
+#define INTERVAL_HEADER_SIZE 16
+#define INTERVAL_FIELDS 7
+
+//counters of one interval
+typedef struct{
+    unsigned long long end;         //memory accesses processed at the end of the interval
+    unsigned long long reads;
+    unsigned long long readMisses;
+    unsigned long long writes;
+    unsigned long long writeMisses;
+    unsigned long long evictions;
+    unsigned long long memoryWrites;
+} interval_sample_t;
+
+//Writes one record per interval to a CSV or binary file. Records go through
+//the stdio buffer and are only flushed when it fills or the log is closed.
+class interval_log{
+    FILE *out;
+    interval_format_t format;
+
+    interval_log(const interval_log &);
+    interval_log &operator=(const interval_log &);
+
+public:
+    interval_log();
+    ~interval_log();
+
+    // creates the file and writes the CSV column names or the binary header;
+    // returns false if it cannot be created
+    bool open(const char *filename, interval_format_t format, unsigned long long interval);
+
+    // appends one interval
+    void write(const interval_sample_t &sample);
+
+    // flushes and closes the file, if any
+    void close();
+
+    bool is_open() const { return out != NULL; }
+};
+
+#endif /* INTERVAL_H_ */
@@ -0,0 +1,279 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#include "cache.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define KERNEL_AVX2
+#include <immintrin.h>
+#endif
+
+//Replay loops of a plain LRU cache (no feature beyond the baseline model),
+//specialized at compile time on the associativity and both write policies.
+//The set index and tag come from a mask and a shift, the way loops have a
+//constant trip count the compiler unrolls, and the policy tests fold away,
+//so the only branches left in the loop are the ones on the data. WAYS = 0
+//is the fallback for other associativities, which reads it at run time.
+//
+//Every decision (first invalid way, LRU victim with ties going to the highest
+//way, dirty and memory write accounting) matches access_block(), so the
+//counters and tag array come out identical to the general path. The loop only
+//writes the lines of the sets it touches and its own kernel_counts_t, so
+//loops over disjoint sets can share one cache (see cache_shard.cc).
+//
+//PROBE looks a tag up in a set of WAYS ways and finds its LRU way: the scalar
+//loops below, or for 8, 16 and 32 ways the AVX2 ones when the host has AVX2.
+
+//scalar way loops for a set of WAYS (> 0) ways
+template <unsigned WAYS>
+struct scalar_probe{
+    // returns the valid ways holding "tag" as a bit mask, and all valid ways in "valid"
+    static unsigned match(const long long *t, const unsigned char *s, long long tag, unsigned &valid){
+        unsigned hits = 0;
+        valid = 0;
+        for(unsigned w = 0; w < WAYS; w++){
+            valid |= unsigned(s[w] & LINE_VALID) << w;
+            hits |= unsigned(t[w] == tag) << w;
+        }
+        return hits & valid;
+    }
+
+    // returns the least recently used way, the highest one on ties
+    static unsigned oldest(const unsigned long long *l){
+        unsigned way = 0;
+        unsigned long long smallest = l[0];
+        for(unsigned w = 1; w < WAYS; w++){
+            if(WAYS <= 4){
+                //short chains of selects beat the unpredictable branch
+                bool older = (l[w] <= smallest);
+                smallest = older ? l[w] : smallest;
+                way = older ? w : way;
+            }
+            else if(l[w] <= smallest){
+                smallest = l[w];
+                way = w;
+            }
+        }
+        return way;
+    }
+};
+
+#ifdef KERNEL_AVX2
+//the same for 8, 16 or 32 ways, four tags or LRU stamps to a 256-bit register
+template <unsigned WAYS>
+struct avx2_probe{
+    __attribute__((target("avx2")))
+    static unsigned match(const long long *t, const unsigned char *s, long long tag, unsigned &valid){
+        static_assert(LINE_VALID == 1, "the valid bit is shifted into the sign bit of its byte");
+        valid = 0;
+        for(unsigned w = 0; w < WAYS; w += 8){
+            __m128i bytes = _mm_loadl_epi64((const __m128i *)(s + w));
+            valid |= unsigned(_mm_movemask_epi8(_mm_slli_epi16(bytes, 7)) & 0xff) << w;
+        }
+        __m256i key = _mm256_set1_epi64x(tag);
+        unsigned hits = 0;
+        for(unsigned w = 0; w < WAYS; w += 4){
+            __m256i same = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(t + w)), key);
+            hits |= unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(same))) << w;
+        }
+        return hits & valid;
+    }
+
+    //stamps are access numbers, far below 2^63, so the signed compare orders them
+    __attribute__((target("avx2")))
+    static unsigned oldest(const unsigned long long *l){
+        __m256i smallest = _mm256_loadu_si256((const __m256i *)l);
+        for(unsigned w = 4; w < WAYS; w += 4){
+            __m256i next = _mm256_loadu_si256((const __m256i *)(l + w));
+            smallest = _mm256_blendv_epi8(smallest, next, _mm256_cmpgt_epi64(smallest, next));
+        }
+        //fold the four lanes so every lane holds the minimum
+        __m256i other = _mm256_permute4x64_epi64(smallest, _MM_SHUFFLE(1, 0, 3, 2));
+        smallest = _mm256_blendv_epi8(smallest, other, _mm256_cmpgt_epi64(smallest, other));
+        other = _mm256_permute4x64_epi64(smallest, _MM_SHUFFLE(2, 3, 0, 1));
+        smallest = _mm256_blendv_epi8(smallest, other, _mm256_cmpgt_epi64(smallest, other));
+
+        unsigned ties = 0;
+        for(unsigned w = 0; w < WAYS; w += 4){
+            __m256i same = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(l + w)), smallest);
+            ties |= unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(same))) << w;
+        }
+        return 31 - __builtin_clz(ties);
+    }
+};
+#endif
+
+template <unsigned WAYS, write_policy_t HIT_POLICY, write_policy_t MISS_POLICY, class PROBE = scalar_probe<WAYS> >
+class lru_kernel{
+public:
+    static void replay(cache &c, const char *ops, const long long *blocks, unsigned count, kernel_counts_t &n){
+        const unsigned ways = WAYS ? WAYS : c.numWays;
+        const unsigned setBits = c.setBits;
+        const long long setMask = c.maskSetBits;     //never reaches c_set, so the modulo of access_block is a no-op
+        long long *tags = &c.tagArray[0];
+        unsigned char *state = &c.stateArray[0];
+        unsigned long long *lru = &c.lruArray[0];
+        unsigned long long clock = n.clock;
+
+        unsigned reads = 0, readMisses = 0, writes = 0, writeMisses = 0;
+        unsigned evictions = 0, memoryWrites = 0;
+        unsigned long long fills = 0, writebacks = 0, writesThrough = 0;
+
+        for(unsigned i = 0; i < count; i++, clock++){
+            char op = ops[i];
+            if(op != 'r' && op != 'w') continue;
+            bool write = (op == 'w');
+            long long block = blocks[i];
+            long long tag = block >> setBits;
+            unsigned base = unsigned(block & setMask) * ways;
+            long long *t = tags + base;
+            unsigned char *s = state + base;
+            unsigned long long *l = lru + base;
+
+            if(write) writes++;
+            else reads++;
+
+            unsigned way = ways;
+            unsigned valid = 0;
+            if(WAYS){
+                //compare every way without branching; at most one valid way holds the tag
+                unsigned hits = PROBE::match(t, s, tag, valid);
+                if(hits) way = __builtin_ctz(hits);
+            }
+            else{
+                for(unsigned w = 0; w < ways; w++){
+                    if(t[w] == tag && (s[w] & LINE_VALID)){
+                        way = w;
+                        break;
+                    }
+                }
+            }
+
+            if(way != ways){
+                l[way] = clock;
+                if(write){
+                    if(HIT_POLICY == WRITE_BACK) s[way] |= LINE_DIRTY;
+                    else{
+                        memoryWrites++;
+                        writesThrough++;
+                    }
+                }
+                continue;
+            }
+
+            if(write) writeMisses++;
+            else readMisses++;
+            if(MISS_POLICY == NO_WRITE_ALLOCATE && write){
+                //the word goes straight to memory
+                if(HIT_POLICY == WRITE_THROUGH) memoryWrites++;
+                writesThrough++;
+                continue;
+            }
+
+            //allocate: the first invalid way, else the least recently used one
+            if(WAYS){
+                unsigned invalid = ~valid & unsigned((1ULL << WAYS) - 1);
+                if(invalid) way = __builtin_ctz(invalid);
+            }
+            else{
+                for(unsigned w = 0; w < ways; w++){
+                    if(!(s[w] & LINE_VALID)){
+                        way = w;
+                        break;
+                    }
+                }
+            }
+            if(way == ways){
+                if(WAYS) way = PROBE::oldest(l);
+                else{
+                    way = 0;
+                    unsigned long long smallest = l[0];
+                    for(unsigned w = 1; w < ways; w++){
+                        if(l[w] <= smallest){
+                            smallest = l[w];
+                            way = w;
+                        }
+                    }
+                }
+                evictions++;
+                if(s[way] & LINE_DIRTY){
+                    memoryWrites++;
+                    writebacks++;
+                }
+            }
+            fills++;
+            t[way] = tag;
+            l[way] = clock;
+            s[way] = LINE_VALID;
+            if(write){
+                if(HIT_POLICY == WRITE_BACK) s[way] = LINE_VALID | LINE_DIRTY;
+                else{
+                    memoryWrites++;
+                    writesThrough++;
+                }
+            }
+        }
+
+        n.clock = clock;
+        n.reads += reads;
+        n.readMisses += readMisses;
+        n.writes += writes;
+        n.writeMisses += writeMisses;
+        n.evictions += evictions;
+        n.memoryWrites += memoryWrites;
+        n.fills += fills;
+        n.writebacks += writebacks;
+        n.writesThrough += writesThrough;
+    }
+};
+
+template <unsigned WAYS>
+static cache_kernel_t select_policies(write_policy_t hit_policy, write_policy_t miss_policy){
+    if(hit_policy == WRITE_BACK){
+        if(miss_policy == WRITE_ALLOCATE) return &lru_kernel<WAYS, WRITE_BACK, WRITE_ALLOCATE>::replay;
+        return &lru_kernel<WAYS, WRITE_BACK, NO_WRITE_ALLOCATE>::replay;
+    }
+    if(miss_policy == WRITE_ALLOCATE) return &lru_kernel<WAYS, WRITE_THROUGH, WRITE_ALLOCATE>::replay;
+    return &lru_kernel<WAYS, WRITE_THROUGH, NO_WRITE_ALLOCATE>::replay;
+}
+
+#ifdef KERNEL_AVX2
+//the AVX2 loop; flattening inlines the probes, which a function without AVX2 could not take in
+template <unsigned WAYS, write_policy_t HIT_POLICY, write_policy_t MISS_POLICY>
+__attribute__((target("avx2"), flatten))
+static void replay_avx2(cache &c, const char *ops, const long long *blocks, unsigned count, kernel_counts_t &n){
+    lru_kernel<WAYS, HIT_POLICY, MISS_POLICY, avx2_probe<WAYS> >::replay(c, ops, blocks, count, n);
+}
+
+template <unsigned WAYS>
+static cache_kernel_t select_avx2_policies(write_policy_t hit_policy, write_policy_t miss_policy){
+    if(hit_policy == WRITE_BACK){
+        if(miss_policy == WRITE_ALLOCATE) return &replay_avx2<WAYS, WRITE_BACK, WRITE_ALLOCATE>;
+        return &replay_avx2<WAYS, WRITE_BACK, NO_WRITE_ALLOCATE>;
+    }
+    if(miss_policy == WRITE_ALLOCATE) return &replay_avx2<WAYS, WRITE_THROUGH, WRITE_ALLOCATE>;
+    return &replay_avx2<WAYS, WRITE_THROUGH, NO_WRITE_ALLOCATE>;
+}
+#endif
+
+cache_kernel_t cache::select_kernel(unsigned ways, write_policy_t hit_policy, write_policy_t miss_policy, bool simd){
+#ifdef KERNEL_AVX2
+    if(simd && __builtin_cpu_supports("avx2")){
+        switch(ways){
+            case 8:  return select_avx2_policies<8>(hit_policy, miss_policy);
+            case 16: return select_avx2_policies<16>(hit_policy, miss_policy);
+            case 32: return select_avx2_policies<32>(hit_policy, miss_policy);
+        }
+    }
+#endif
+    switch(ways){
+        case 1:  return select_policies<1>(hit_policy, miss_policy);
+        case 2:  return select_policies<2>(hit_policy, miss_policy);
+        case 4:  return select_policies<4>(hit_policy, miss_policy);
+        case 8:  return select_policies<8>(hit_policy, miss_policy);
+        case 16: return select_policies<16>(hit_policy, miss_policy);
+        default: return select_policies<0>(hit_policy, miss_policy);
+    }
+}
@@ -0,0 +1,40 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#ifndef LE_BYTES_H_
+#define LE_BYTES_H_
+
+#include <vector>
+#include <stddef.h>
+
+//Little-endian field helpers shared by the binary trace, interval log and
+//checkpoint formats, so files read the same on any host.
+
+// stores the low "bytes" bytes of "value" at "out", least significant first
+inline void put_le(unsigned char *out, unsigned long long value, unsigned bytes){
+    for(unsigned i = 0; i < bytes; i++) out[i] = (unsigned char)(value >> (8 * i));
+}
+
+// reads a "bytes" byte little-endian field
+inline unsigned long long get_le(const unsigned char *in, unsigned bytes){
+    unsigned long long value = 0;
+    for(unsigned i = 0; i < bytes; i++) value |= (unsigned long long)in[i] << (8 * i);
+    return value;
+}
+
+// appends "count" values of sizeof(T) bytes each, little-endian
+template <typename T> inline void put_le_array(std::vector<unsigned char> &out, const T *values, size_t count){
+    size_t at = out.size();
+    out.resize(at + count * sizeof(T));
+    for(size_t i = 0; i < count; i++) put_le(&out[at + i * sizeof(T)], (unsigned long long)values[i], sizeof(T));
+}
+
+// reads "count" values written by put_le_array; returns the number of bytes read
+template <typename T> inline size_t get_le_array(const unsigned char *in, T *values, size_t count){
+    for(size_t i = 0; i < count; i++) values[i] = (T)get_le(in + i * sizeof(T), sizeof(T));
+    return count * sizeof(T);
+}
+
+#endif /*LE_BYTES_H_*/
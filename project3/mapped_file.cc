@@ -0,0 +1,60 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#include "mapped_file.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+mapped_file::mapped_file(){
+    data = NULL;
+    length = 0;
+    mapSize = 0;
+}
+
+mapped_file::~mapped_file(){
+    close();
+}
+
+bool mapped_file::open(const char *filename, bool sequential){
+    close();
+
+    int fd = ::open(filename, O_RDONLY);
+    if(fd < 0) return false;
+
+    struct stat st;
+    if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0){
+        void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(map != MAP_FAILED){
+            if(sequential) madvise(map, st.st_size, MADV_SEQUENTIAL);
+            mapSize = st.st_size;
+            data = (const char *)map;
+            length = mapSize;
+        }
+    }
+
+    //pipes and other unmappable inputs are read into memory instead
+    if(mapSize == 0){
+        char chunk[1 << 16];
+        ssize_t n;
+        while((n = ::read(fd, chunk, sizeof(chunk))) > 0){
+            buffer.insert(buffer.end(), chunk, chunk + n);
+        }
+        data = buffer.empty() ? NULL : &buffer[0];
+        length = buffer.size();
+    }
+
+    ::close(fd);
+    return true;
+}
+
+void mapped_file::close(){
+    if(mapSize != 0) munmap((void *)data, mapSize);
+    mapSize = 0;
+    buffer.clear();
+    data = NULL;
+    length = 0;
+}
@@ -0,0 +1,38 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+#include <stddef.h>
+#include <vector>
+
+//Read-only view of a whole file, shared by the trace reader and checkpoints.
+//Regular files are memory-mapped; pipes and other inputs that cannot be
+//mapped are read into memory instead.
+class mapped_file{
+    const char *data;       //start of the mapping (or buffer), NULL when empty
+    size_t length;
+    size_t mapSize;         //length of the mapping, 0 if nothing is mapped
+    std::vector<char> buffer; //fallback storage for files that cannot be mapped
+
+    mapped_file(const mapped_file &);
+    mapped_file &operator=(const mapped_file &);
+
+public:
+    mapped_file();
+    ~mapped_file();
+
+    // maps "filename"; "sequential" tells the kernel it will be read front to back
+    // returns false if the file cannot be opened
+    bool open(const char *filename, bool sequential=false);
+
+    // releases the file, if any
+    void close();
+
+    const char *begin() const { return data; }
+    size_t size() const { return length; }
+};
+
+#endif /*MAPPED_FILE_H_*/
@@ -0,0 +1,192 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#include "prefetcher.h"
+#include <stddef.h>
+
+using namespace std;
+
+#define STRIDE_TABLE 64         //stride detectors, indexed by 4KB page
+#define STRIDE_PAGE_BITS 12
+#define STRIDE_CONFIDENT 2      //matching deltas needed before prefetching
+#define STREAM_TRACKERS 16      //concurrent sequential streams
+#define STREAM_WINDOW 16        //blocks past a tracker's head that still count as the stream
+#define REGION_BYTES 2048       //spatial region size
+#define REGION_ACTIVE 64        //regions recording their footprint
+#define REGION_HISTORY 1024     //footprints remembered from earlier generations
+
+/* Next-line: the following "degree" blocks */
+
+class next_line_prefetcher : public prefetcher{
+    unsigned degree;
+public:
+    next_line_prefetcher(unsigned d) : degree(d) {}
+    void observe(long long block, bool, vector<long long> &blocks){
+        for(unsigned k = 1; k <= degree; k++) blocks.push_back(block + k);
+    }
+};
+
+/* Stride: PC-less, so deltas are tracked per 4KB page to separate interleaved streams */
+
+typedef struct{
+    long long page;
+    long long last;
+    long long stride;
+    unsigned confidence;
+} stride_entry;
+
+class stride_prefetcher : public prefetcher{
+    unsigned degree;
+    unsigned pageShift;
+    vector<stride_entry> table;
+public:
+    stride_prefetcher(unsigned d, unsigned block_size) : degree(d), pageShift(0), table(STRIDE_TABLE) {
+        while((block_size << pageShift) < (1u << STRIDE_PAGE_BITS)) pageShift++;
+        for(unsigned i = 0; i < table.size(); i++){
+            table[i].page = -1;
+            table[i].confidence = 0;
+        }
+    }
+    void observe(long long block, bool, vector<long long> &blocks){
+        long long page = block >> pageShift;
+        stride_entry &e = table[(unsigned long long)page % STRIDE_TABLE];
+        if(e.page != page){
+            e.page = page;
+            e.last = block;
+            e.stride = 0;
+            e.confidence = 0;
+            return;
+        }
+        long long stride = block - e.last;
+        if(stride == 0) return;
+        if(stride == e.stride){
+            if(e.confidence < STRIDE_CONFIDENT) e.confidence++;
+        }
+        else{
+            e.stride = stride;
+            e.confidence = 0;
+        }
+        e.last = block;
+        if(e.confidence >= STRIDE_CONFIDENT){
+            for(unsigned k = 1; k <= degree; k++) blocks.push_back(block + e.stride * (long long)k);
+        }
+    }
+};
+
+/* Stream: trackers follow ascending or descending runs of misses and run
+   "degree" blocks ahead of each one */
+
+typedef struct{
+    long long head;     //last block requested in the stream
+    int direction;      //+1, -1, or 0 while unconfirmed
+    unsigned lastUse;
+} stream_entry;
+
+class stream_prefetcher : public prefetcher{
+    unsigned degree;
+    vector<stream_entry> trackers;
+    unsigned clock;
+public:
+    stream_prefetcher(unsigned d) : degree(d), trackers(STREAM_TRACKERS), clock(0) {
+        for(unsigned i = 0; i < trackers.size(); i++){
+            trackers[i].head = -1;
+            trackers[i].direction = 0;
+            trackers[i].lastUse = 0;
+        }
+    }
+    void observe(long long block, bool, vector<long long> &blocks){
+        clock++;
+        unsigned lru = 0;
+        for(unsigned i = 0; i < trackers.size(); i++){
+            stream_entry &t = trackers[i];
+            long long distance = block - t.head;
+            bool inWindow = t.head >= 0 && distance != 0 &&
+                            distance <= STREAM_WINDOW && distance >= -STREAM_WINDOW;
+            if(inWindow && (t.direction == 0 || (distance > 0) == (t.direction > 0))){
+                t.direction = (distance > 0) ? 1 : -1;
+                t.head = block;
+                t.lastUse = clock;
+                for(unsigned k = 1; k <= degree; k++) blocks.push_back(block + t.direction * (long long)k);
+                return;
+            }
+            if(t.lastUse < trackers[lru].lastUse) lru = i;
+        }
+        //start a new, unconfirmed stream in the least recently used tracker
+        trackers[lru].head = block;
+        trackers[lru].direction = 0;
+        trackers[lru].lastUse = clock;
+    }
+};
+
+/* Spatial region: remembers which blocks of a region were used during its
+   last generation and fetches them all when the region is touched again */
+
+typedef struct{
+    long long region;
+    unsigned long long footprint;
+} region_entry;
+
+class spatial_prefetcher : public prefetcher{
+    unsigned regionShift;
+    vector<region_entry> active;
+    vector<region_entry> history;
+
+    void retire(region_entry &e){
+        if(e.region < 0) return;
+        region_entry &h = history[(unsigned long long)e.region % REGION_HISTORY];
+        h = e;
+    }
+public:
+    spatial_prefetcher(unsigned block_size) : regionShift(0), active(REGION_ACTIVE), history(REGION_HISTORY) {
+        while((block_size << regionShift) < REGION_BYTES && regionShift < 6) regionShift++;
+        for(unsigned i = 0; i < active.size(); i++) active[i].region = -1;
+        for(unsigned i = 0; i < history.size(); i++) history[i].region = -1;
+    }
+    void observe(long long block, bool, vector<long long> &blocks){
+        long long region = block >> regionShift;
+        unsigned offset = (unsigned)(block & ((1LL << regionShift) - 1));
+        region_entry &e = active[(unsigned long long)region % REGION_ACTIVE];
+        if(e.region == region){
+            e.footprint |= 1ULL << offset;
+            return;
+        }
+
+        //trigger access: end the generation of the region it displaces and
+        //replay the footprint this region had last time
+        retire(e);
+        e.region = region;
+        e.footprint = 1ULL << offset;
+
+        const region_entry &h = history[(unsigned long long)region % REGION_HISTORY];
+        if(h.region == region){
+            long long base = region << regionShift;
+            for(unsigned k = 0; k < (1u << regionShift); k++){
+                if(k != offset && ((h.footprint >> k) & 1)) blocks.push_back(base + k);
+            }
+        }
+    }
+};
+
+prefetcher *make_prefetcher(prefetch_policy_t policy, unsigned degree, unsigned block_size){
+    if(degree == 0) degree = 1;
+    switch(policy){
+        case PREFETCH_NEXT_LINE: return new next_line_prefetcher(degree);
+        case PREFETCH_STRIDE:    return new stride_prefetcher(degree, block_size);
+        case PREFETCH_STREAM:    return new stream_prefetcher(degree);
+        case PREFETCH_SPATIAL:   return new spatial_prefetcher(block_size);
+        default:                 return NULL;
+    }
+}
+
+const char *prefetch_policy_name(prefetch_policy_t policy){
+    switch(policy){
+        case PREFETCH_NONE:      return "none";
+        case PREFETCH_NEXT_LINE: return "next-line";
+        case PREFETCH_STRIDE:    return "stride";
+        case PREFETCH_STREAM:    return "stream";
+        case PREFETCH_SPATIAL:   return "spatial";
+    }
+    return "unknown";
+}
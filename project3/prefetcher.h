@@ -0,0 +1,32 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#ifndef PREFETCHER_H_
+#define PREFETCHER_H_
+
+#include <vector>
+
+typedef enum {PREFETCH_NONE, PREFETCH_NEXT_LINE, PREFETCH_STRIDE, PREFETCH_STREAM, PREFETCH_SPATIAL} prefetch_policy_t;
+
+//A hardware prefetcher watching the demand stream of one cache. It is told
+//about demand misses and about the first demand hit on a prefetched line
+//(so a running stream keeps going), and answers with the blocks (addresses
+//with the block offset shifted out) to bring into the cache.
+class prefetcher{
+public:
+    virtual ~prefetcher() {}
+
+    // appends the blocks to prefetch after a demand miss or prefetch hit on "block"
+    virtual void observe(long long block, bool miss, std::vector<long long> &blocks) = 0;
+};
+
+// builds a prefetcher issuing up to "degree" blocks per trigger;
+// "block_size" is the cache line size, used to size spatial regions
+prefetcher *make_prefetcher(prefetch_policy_t policy, unsigned degree, unsigned block_size);
+
+// name printed in the cache configuration
+const char *prefetch_policy_name(prefetch_policy_t policy);
+
+#endif /*PREFETCHER_H_*/
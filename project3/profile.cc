@@ -0,0 +1,133 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#include "profile.h"
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+using namespace std;
+
+#define PROFILE_SLOTS 1024  //initial table size (power of two)
+
+static unsigned hash_key(long long key){
+    unsigned long long h = (unsigned long long)key * 0x9E3779B97F4A7C15ULL;
+    return (unsigned)(h >> 32);
+}
+
+static bool more_misses(const profile_entry &a, const profile_entry &b){
+    if(a.misses != b.misses) return a.misses > b.misses;
+    if(a.evictions != b.evictions) return a.evictions > b.evictions;
+    return a.key < b.key;
+}
+
+profile_table::profile_table(){
+    profile_entry empty = {0, 0, 0, 0, 0, false};
+    slots.assign(PROFILE_SLOTS, empty);
+    mask = PROFILE_SLOTS - 1;
+    count = 0;
+}
+
+void profile_table::grow(){
+    vector<profile_entry> old;
+    old.swap(slots);
+    profile_entry empty = {0, 0, 0, 0, 0, false};
+    slots.assign(old.size() * 2, empty);
+    mask = slots.size() - 1;
+    for(unsigned i = 0; i < old.size(); i++){
+        if(!old[i].used) continue;
+        unsigned s = hash_key(old[i].key) & mask;
+        while(slots[s].used) s = (s + 1) & mask;
+        slots[s] = old[i];
+    }
+}
+
+profile_entry &profile_table::operator[](long long key){
+    unsigned s = hash_key(key) & mask;
+    while(slots[s].used){
+        if(slots[s].key == key) return slots[s];
+        s = (s + 1) & mask;
+    }
+    if(4 * (count + 1) > 3 * slots.size()){
+        grow();
+        return (*this)[key];
+    }
+    count++;
+    slots[s].used = true;
+    slots[s].key = key;
+    return slots[s];
+}
+
+vector<profile_entry> profile_table::top(unsigned n) const{
+    vector<profile_entry> entries;
+    entries.reserve(count);
+    for(unsigned i = 0; i < slots.size(); i++) if(slots[i].used) entries.push_back(slots[i]);
+    if(n > entries.size()) n = entries.size();
+    partial_sort(entries.begin(), entries.begin() + n, entries.end(), more_misses);
+    entries.resize(n);
+    return entries;
+}
+
+miss_profile::miss_profile(unsigned page_size){
+    pageBits = log2(page_size ? page_size : 1);
+    seenPC = false;
+    seenTag = false;
+}
+
+void miss_profile::record(long long pc, long long tag, long long address, bool miss,
+                          bool evicted, long long victim, bool victimDirty){
+    seenPC = seenPC || pc != 0;
+    seenTag = seenTag || tag != 0;
+
+    profile_entry &p = byPC[pc];
+    profile_entry &t = byTag[tag];
+    profile_entry &a = byPage[address >> pageBits];
+    p.accesses++;
+    t.accesses++;
+    a.accesses++;
+    if(!miss) return;
+    p.misses++;
+    t.misses++;
+    a.misses++;
+    if(!evicted) return;
+
+    profile_entry &v = byPage[victim >> pageBits];
+    p.evictions++;
+    t.evictions++;
+    v.evictions++;
+    if(victimDirty){
+        p.writebacks++;
+        t.writebacks++;
+        v.writebacks++;
+    }
+}
+
+void miss_profile::print_table(const char *title, const char *column, const profile_table &table, unsigned n) const{
+    vector<profile_entry> rows = table.top(n);
+    cout << title << endl;
+    cout << setfill(' ') << setw(18) << column << setw(11) << "accesses" << setw(11) << "misses"
+         << setw(11) << "miss rate" << setw(11) << "evictions" << setw(11) << "writebacks" << endl;
+    for(unsigned i = 0; i < rows.size(); i++){
+        const profile_entry &r = rows[i];
+        cout << setw(4) << "0x" << setw(14) << left << hex << r.key << right << dec
+             << setw(11) << r.accesses << setw(11) << r.misses
+             << setw(11) << setprecision(4) << (r.accesses ? double(r.misses) / r.accesses : 0.0)
+             << setw(11) << r.evictions << setw(11) << r.writebacks << endl;
+    }
+    cout << setprecision(6);
+}
+
+void miss_profile::print(unsigned n) const{
+    if(seenPC){
+        print_table("TOP MISS PCS", "pc", byPC, n);
+        cout << endl;
+    }
+    print_table("TOP MISS PAGES", "page", byPage, n);
+    if(seenTag){
+        cout << endl;
+        print_table("TOP MISS TAGS", "tag", byTag, n);
+    }
+}
@@ -0,0 +1,68 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <vector>
+
+//counters aggregated under one key (a PC, a page or a data-structure tag)
+typedef struct{
+    long long key;
+    unsigned long long accesses;
+    unsigned long long misses;
+    unsigned long long evictions;
+    unsigned long long writebacks;
+    bool used;
+} profile_entry;
+
+//Open-addressing hash table of profile entries: linear probing over a
+//power-of-two array that doubles at 3/4 load. Entries are never removed.
+class profile_table{
+    std::vector<profile_entry> slots;
+    unsigned mask;
+    unsigned count;
+
+    void grow();
+
+public:
+    profile_table();
+
+    // returns the entry of "key", adding an empty one if it is new
+    profile_entry &operator[](long long key);
+
+    // the "n" entries with the most misses, most first (ties go to evictions, then keys)
+    std::vector<profile_entry> top(unsigned n) const;
+
+    unsigned size() const { return count; }
+};
+
+//Attributes misses, evictions and dirty writebacks to the PC, the page and
+//the data-structure tag of each access. An access's miss is charged to its
+//own PC, page and tag; the line it evicts (and writes back, if dirty) is
+//charged to the evicting PC and tag but to the victim's page, so the page
+//table shows which data was thrown out and the PC table which code threw it.
+class miss_profile{
+    profile_table byPC;
+    profile_table byPage;
+    profile_table byTag;
+    unsigned pageBits;
+    bool seenPC;
+    bool seenTag;
+
+    void print_table(const char *title, const char *column, const profile_table &table, unsigned n) const;
+
+public:
+    miss_profile(unsigned page_size);
+
+    // records one access; "victim" is the byte address of the line it evicted, if any
+    void record(long long pc, long long tag, long long address, bool miss,
+                bool evicted, long long victim, bool victimDirty);
+
+    // prints the "n" PCs, pages and tags with the most misses (PCs and tags only if the trace had them)
+    void print(unsigned n) const;
+};
+
+#endif /*PROFILE_H_*/
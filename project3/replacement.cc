@@ -0,0 +1,256 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#include "replacement.h"
+#include "le_bytes.h"
+
+using namespace std;
+
+#define RRPV_MAX 3          //2-bit re-reference prediction values
+#define BRRIP_THROTTLE 32   //BRRIP inserts at RRPV_MAX-1 once every this many fills
+#define PSEL_MAX 1023       //10-bit DRRIP policy selector
+#define DUEL_PERIOD 32      //one SRRIP and one BRRIP leader set per this many sets
+#define LFU_MAX 255         //saturating 8-bit use counters
+#define MAX_POLICY_WAYS 64  //per-set state is at most one 64-bit word of bits
+
+//small xorshift generator, so random replacement is repeatable across runs
+static unsigned next_random(unsigned long long &state){
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return (unsigned)(state >> 32);
+}
+
+//checkpoint helpers: the state is a plain concatenation of the policy's arrays and scalars,
+//each value little-endian
+template <typename T> static void put_array(vector<unsigned char> &out, const vector<T> &v){
+    if(!v.empty()) put_le_array(out, &v[0], v.size());
+}
+
+template <typename T> static size_t get_array(const unsigned char *in, vector<T> &v){
+    return v.empty() ? 0 : get_le_array(in, &v[0], v.size());
+}
+
+/* FIFO: one insertion pointer per set */
+
+class fifo_policy : public replacement_policy{
+    unsigned ways;
+    vector<unsigned char> next;
+public:
+    fifo_policy(unsigned sets, unsigned w) : ways(w), next(sets, 0) {}
+    void on_hit(unsigned, unsigned) {}
+    void on_fill(unsigned set, unsigned way){
+        if(way == next[set]) next[set] = (way + 1) % ways;
+    }
+    unsigned victim(unsigned set){ return next[set]; }
+    void save(vector<unsigned char> &out) const { put_array(out, next); }
+    bool load(const unsigned char *in, size_t size){
+        if(size != next.size()) return false;
+        get_array(in, next);
+        return true;
+    }
+};
+
+/* Random: no per-set state */
+
+class random_policy : public replacement_policy{
+    unsigned ways;
+    unsigned long long state;
+public:
+    random_policy(unsigned w) : ways(w), state(0x9E3779B97F4A7C15ULL) {}
+    void on_hit(unsigned, unsigned) {}
+    void on_fill(unsigned, unsigned) {}
+    unsigned victim(unsigned){ return next_random(state) % ways; }
+    void save(vector<unsigned char> &out) const { put_le_array(out, &state, 1); }
+    bool load(const unsigned char *in, size_t size){
+        if(size != sizeof(state)) return false;
+        get_le_array(in, &state, 1);
+        return true;
+    }
+};
+
+/* Tree-PLRU: ways-1 direction bits per set, node i has children 2i and 2i+1.
+   A bit of 1 means the victim search goes to the upper half. */
+
+class tree_plru_policy : public replacement_policy{
+    unsigned levels;
+    vector<unsigned long long> bits;
+
+    void touch(unsigned set, unsigned way){
+        unsigned long long b = bits[set];
+        unsigned node = 1;
+        for(unsigned l = levels; l > 0; l--){
+            unsigned upper = (way >> (l - 1)) & 1;
+            //point away from the half that was just used
+            if(upper) b &= ~(1ULL << node);
+            else b |= (1ULL << node);
+            node = 2 * node + upper;
+        }
+        bits[set] = b;
+    }
+public:
+    tree_plru_policy(unsigned sets, unsigned ways) : levels(0), bits(sets, 0) {
+        while((1u << levels) < ways) levels++;
+    }
+    void on_hit(unsigned set, unsigned way){ touch(set, way); }
+    void on_fill(unsigned set, unsigned way){ touch(set, way); }
+    unsigned victim(unsigned set){
+        unsigned node = 1;
+        for(unsigned l = 0; l < levels; l++) node = 2 * node + ((bits[set] >> node) & 1);
+        return node - (1u << levels);
+    }
+    void save(vector<unsigned char> &out) const { put_array(out, bits); }
+    bool load(const unsigned char *in, size_t size){
+        if(size != bits.size() * sizeof(bits[0])) return false;
+        get_array(in, bits);
+        return true;
+    }
+};
+
+/* NRU: one reference bit per line */
+
+class nru_policy : public replacement_policy{
+    unsigned long long all;     //one bit per way
+    vector<unsigned long long> referenced;
+    void touch(unsigned set, unsigned way){
+        referenced[set] |= (1ULL << way);
+        if(referenced[set] == all) referenced[set] = (1ULL << way);
+    }
+public:
+    nru_policy(unsigned sets, unsigned ways)
+        : all((ways == 64) ? ~0ULL : ((1ULL << ways) - 1)), referenced(sets, 0) {}
+    void on_hit(unsigned set, unsigned way){ touch(set, way); }
+    void on_fill(unsigned set, unsigned way){ touch(set, way); }
+    unsigned victim(unsigned set){
+        unsigned long long free = ~referenced[set] & all;
+        return free ? __builtin_ctzll(free) : 0;
+    }
+    void save(vector<unsigned char> &out) const { put_array(out, referenced); }
+    bool load(const unsigned char *in, size_t size){
+        if(size != referenced.size() * sizeof(referenced[0])) return false;
+        get_array(in, referenced);
+        return true;
+    }
+};
+
+/* RRIP family: a 2-bit re-reference prediction value per line.
+   SRRIP inserts at RRPV_MAX-1, BRRIP mostly at RRPV_MAX, and DRRIP picks
+   between them with a saturating counter trained on dedicated leader sets. */
+
+class rrip_policy : public replacement_policy{
+    replacement_policy_t mode;
+    unsigned ways;
+    unsigned sets;
+    vector<unsigned char> rrpv;
+    unsigned fills;     //BRRIP throttle
+    unsigned psel;      //DRRIP selector, high favours BRRIP
+
+    bool srrip_leader(unsigned set) const { return set % DUEL_PERIOD == 0; }
+    bool brrip_leader(unsigned set) const {
+        return sets > 1 && set % DUEL_PERIOD == (sets < DUEL_PERIOD ? sets - 1 : DUEL_PERIOD - 1);
+    }
+
+    bool use_brrip(unsigned set){
+        if(mode == REPLACE_SRRIP) return false;
+        if(mode == REPLACE_BRRIP) return true;
+        if(srrip_leader(set)){
+            if(psel < PSEL_MAX) psel++;
+            return false;
+        }
+        if(brrip_leader(set)){
+            if(psel > 0) psel--;
+            return true;
+        }
+        return psel > PSEL_MAX / 2;
+    }
+public:
+    rrip_policy(replacement_policy_t m, unsigned s, unsigned w)
+        : mode(m), ways(w), sets(s), rrpv((size_t)s * w, RRPV_MAX), fills(0), psel(PSEL_MAX / 2) {}
+    void on_hit(unsigned set, unsigned way){ rrpv[(size_t)set * ways + way] = 0; }
+    void on_fill(unsigned set, unsigned way){
+        //every fill is a miss, which is what trains the DRRIP selector
+        unsigned char insert = RRPV_MAX - 1;
+        if(use_brrip(set)){
+            insert = (++fills % BRRIP_THROTTLE == 0) ? RRPV_MAX - 1 : RRPV_MAX;
+        }
+        rrpv[(size_t)set * ways + way] = insert;
+    }
+    unsigned victim(unsigned set){
+        unsigned char *r = &rrpv[(size_t)set * ways];
+        for(;;){
+            for(unsigned i = 0; i < ways; i++) if(r[i] == RRPV_MAX) return i;
+            for(unsigned i = 0; i < ways; i++) r[i]++;
+        }
+    }
+    void save(vector<unsigned char> &out) const {
+        put_array(out, rrpv);
+        put_le_array(out, &fills, 1);
+        put_le_array(out, &psel, 1);
+    }
+    bool load(const unsigned char *in, size_t size){
+        if(size != rrpv.size() + sizeof(fills) + sizeof(psel)) return false;
+        in += get_array(in, rrpv);
+        in += get_le_array(in, &fills, 1);
+        get_le_array(in, &psel, 1);
+        return true;
+    }
+};
+
+/* LFU: a saturating use counter per line, ties go to the lowest way */
+
+class lfu_policy : public replacement_policy{
+    unsigned ways;
+    vector<unsigned char> count;
+public:
+    lfu_policy(unsigned sets, unsigned w) : ways(w), count((size_t)sets * w, 0) {}
+    void on_hit(unsigned set, unsigned way){
+        unsigned char &c = count[(size_t)set * ways + way];
+        if(c < LFU_MAX) c++;
+    }
+    void on_fill(unsigned set, unsigned way){ count[(size_t)set * ways + way] = 1; }
+    unsigned victim(unsigned set){
+        const unsigned char *c = &count[(size_t)set * ways];
+        unsigned way = 0;
+        for(unsigned i = 1; i < ways; i++) if(c[i] < c[way]) way = i;
+        return way;
+    }
+    void save(vector<unsigned char> &out) const { put_array(out, count); }
+    bool load(const unsigned char *in, size_t size){
+        if(size != count.size()) return false;
+        get_array(in, count);
+        return true;
+    }
+};
+
+replacement_policy *make_replacement_policy(replacement_policy_t policy, unsigned sets, unsigned ways){
+    if(ways == 0 || ways > MAX_POLICY_WAYS) return NULL;
+    if(policy == REPLACE_TREE_PLRU && (ways & (ways - 1)) != 0) return NULL;
+    switch(policy){
+        case REPLACE_FIFO:      return new fifo_policy(sets, ways);
+        case REPLACE_RANDOM:    return new random_policy(ways);
+        case REPLACE_TREE_PLRU: return new tree_plru_policy(sets, ways);
+        case REPLACE_NRU:       return new nru_policy(sets, ways);
+        case REPLACE_SRRIP:
+        case REPLACE_BRRIP:
+        case REPLACE_DRRIP:     return new rrip_policy(policy, sets, ways);
+        case REPLACE_LFU:       return new lfu_policy(sets, ways);
+        default:                return NULL;
+    }
+}
+
+const char *replacement_policy_name(replacement_policy_t policy){
+    switch(policy){
+        case REPLACE_LRU:       return "LRU";
+        case REPLACE_FIFO:      return "FIFO";
+        case REPLACE_RANDOM:    return "random";
+        case REPLACE_TREE_PLRU: return "tree-PLRU";
+        case REPLACE_NRU:       return "NRU";
+        case REPLACE_SRRIP:     return "SRRIP";
+        case REPLACE_BRRIP:     return "BRRIP";
+        case REPLACE_DRRIP:     return "DRRIP";
+        case REPLACE_LFU:       return "LFU";
+    }
+    return "unknown";
+}
@@ -0,0 +1,46 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#ifndef REPLACEMENT_H_
+#define REPLACEMENT_H_
+
+#include <stddef.h>
+#include <vector>
+
+typedef enum {REPLACE_LRU, REPLACE_FIFO, REPLACE_RANDOM, REPLACE_TREE_PLRU, REPLACE_NRU,
+              REPLACE_SRRIP, REPLACE_BRRIP, REPLACE_DRRIP, REPLACE_LFU} replacement_policy_t;
+
+//Replacement state of a whole cache. The cache reports every hit and every
+//fill (including fills of invalid ways) and asks for a victim only when a set
+//is full. LRU is not implemented here: the cache keeps it inline with one
+//timestamp per line.
+class replacement_policy{
+public:
+    virtual ~replacement_policy() {}
+
+    // a valid line was accessed
+    virtual void on_hit(unsigned set, unsigned way) = 0;
+
+    // a new block was placed in a line
+    virtual void on_fill(unsigned set, unsigned way) = 0;
+
+    // returns the way to evict from a full set
+    virtual unsigned victim(unsigned set) = 0;
+
+    // appends the policy state to "out", for checkpoints
+    virtual void save(std::vector<unsigned char> &out) const = 0;
+
+    // restores a state written by "save" for the same geometry; returns false if "size" does not match
+    virtual bool load(const unsigned char *in, size_t size) = 0;
+};
+
+// builds the state for "policy" (not REPLACE_LRU) over "sets" sets of "ways" ways; returns NULL,
+// and the cache falls back to LRU, for more than 64 ways or tree-PLRU with a non-power-of-two way count
+replacement_policy *make_replacement_policy(replacement_policy_t policy, unsigned sets, unsigned ways);
+
+// name printed in the cache configuration
+const char *replacement_policy_name(replacement_policy_t policy);
+
+#endif /*REPLACEMENT_H_*/
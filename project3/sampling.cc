@@ -0,0 +1,185 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#include "cache.h"
+#include <cmath>
+
+//Sampled simulation of one cache. Set sampling simulates a fixed subset of
+//the sets; since accesses to different sets only interact through the
+//replacement policy's shared state (if any), the sampled sets behave as they
+//would in the full cache. Interval sampling only keeps the tags, dirty bits
+//and replacement state up to date for most of each period (functional
+//warming, which counts nothing), simulates the accesses just before the
+//measured window in full to warm the rest of the state (prefetcher, victim
+//cache, timing) and measures the window alone.
+//
+//Either way, the sampled units (sets or windows) give a ratio estimate of the
+//miss rate, whose standard error comes from the spread of the per-unit miss
+//counts around it.
+
+#define Z_95 1.96   //two-sided 95% normal quantile
+
+void cache::set_set_sampling(unsigned one_in){
+    samplingMode = (one_in > 1) ? SAMPLE_SETS : SAMPLE_NONE;
+    sampleSets = (one_in > 1) ? one_in : 1;
+    sampleAccesses.assign((c_set + sampleSets - 1) / sampleSets, 0);
+    sampleMisses.assign(sampleAccesses.size(), 0);
+    sampleTotal = 0;
+    sampleEvict = 0;
+    sampleMemWrite = 0;
+    windowOpen = false;
+}
+
+void cache::set_interval_sampling(unsigned period, unsigned detail, unsigned warmup){
+    if(detail > period) detail = period;
+    if(warmup > period - detail) warmup = period - detail;
+    samplingMode = (period != 0 && detail != 0) ? SAMPLE_INTERVALS : SAMPLE_NONE;
+    samplePeriod = period;
+    sampleDetail = detail;
+    sampleWarmup = warmup;
+    sampleAccesses.clear();
+    sampleMisses.clear();
+    sampleTotal = 0;
+    sampleEvict = 0;
+    sampleMemWrite = 0;
+    windowOpen = false;
+}
+
+void cache::run_sampled(unsigned num_entries){
+    unsigned long long first_access = number_memory_accesses;
+    unsigned skip = samplePeriod - sampleWarmup - sampleDetail;
+    char op;
+    address_t address;
+
+    while (trace.next(op, address)){
+        bool demand = (op == 'r' || op == 'w');
+        unsigned phase = (samplingMode == SAMPLE_INTERVALS) ? unsigned(sampleTotal % samplePeriod) : 0;
+        //the TLBs are warmed along with the cache on the accesses that are not simulated
+        bool simulated = (samplingMode == SAMPLE_SETS || phase >= skip);
+        long long block = tlbs ? translate(address, simulated) : address >> blkoffBits;
+        unsigned sector = (address >> sectorBits) & (numSectors - 1);
+
+        if(samplingMode == SAMPLE_SETS){
+            unsigned set = unsigned((block & maskSetBits) % c_set);
+            if(set % sampleSets == 0){
+                access_block(op, block, sector);
+                if(demand){
+                    sampleAccesses[set / sampleSets]++;
+                    if(!outcome.hit) sampleMisses[set / sampleSets]++;
+                }
+            }
+        }
+        else if(demand){
+            //the phase only advances on reads and writes, so other entries leave the windows alone
+            if(phase == skip + sampleWarmup){
+                windowOpen = true;
+                windowEvict = numEvict;
+                windowMemWrite = numMemWrite;
+                sampleAccesses.push_back(0);
+                sampleMisses.push_back(0);
+            }
+            if(phase < skip) warm_block(op, block, sector);
+            else{
+                access_block(op, block, sector);
+                if(windowOpen){
+                    sampleAccesses.back()++;
+                    if(!outcome.hit) sampleMisses.back()++;
+                }
+            }
+            if(windowOpen && phase == samplePeriod - 1){
+                windowOpen = false;
+                sampleEvict += numEvict - windowEvict;
+                sampleMemWrite += numMemWrite - windowMemWrite;
+            }
+        }
+        if(demand) sampleTotal++;
+
+        number_memory_accesses++;
+        if (num_entries!=0 && (number_memory_accesses-first_access)==num_entries)
+            break;
+    }
+}
+
+void cache::warm_block(char op, long long block, unsigned sector){
+    bool write = (op == 'w');
+    if(!write && op != 'r') return;
+    long long tag = block >> setBits;
+    long long setIndex = (block & maskSetBits) % c_set;
+    unsigned base = setBase(setIndex);
+    unsigned line = findLine(base, tag);
+
+    if(line != NO_LINE){
+        if(numSectors > 1) sectorValid[line] |= (1u << sector);
+        touch(setIndex, line);
+    }
+    else{
+        if(write && missPolicy == NO_WRITE_ALLOCATE) return;
+        //same line as allocate() picks; the victim is dropped without a writeback
+        for(unsigned i = base; i < base + numWays; i++){
+            if(!(stateArray[i] & LINE_VALID)){
+                line = i;
+                break;
+            }
+        }
+        if(line == NO_LINE) line = base + victim_way(setIndex);
+        stateArray[line] = LINE_VALID;
+        tagArray[line] = tag;
+        if(numSectors > 1){
+            sectorValid[line] = (1u << sector);
+            sectorDirty[line] = 0;
+        }
+        filled(setIndex, line);
+    }
+    if(write && hitPolicy == WRITE_BACK) mark_dirty(line, sector);
+}
+
+sample_estimate_t cache::sampling_estimate() const{
+    sample_estimate_t e;
+    e.accesses = sampleTotal;
+    e.measured = 0;
+    e.units = 0;
+
+    unsigned long long misses = 0;
+    for(unsigned i = 0; i < sampleAccesses.size(); i++){
+        e.measured += sampleAccesses[i];
+        misses += sampleMisses[i];
+        if(sampleAccesses[i]) e.units++;
+    }
+    e.missRate = e.measured ? double(misses) / double(e.measured) : 0.0;
+
+    //variance of the ratio estimate over the sampled units, with the finite population
+    //correction for the share of all sets (or window-sized stretches of the trace) that was sampled
+    double spread = 0;
+    for(unsigned i = 0; i < sampleAccesses.size(); i++){
+        if(!sampleAccesses[i]) continue;
+        double d = double(sampleMisses[i]) - e.missRate * double(sampleAccesses[i]);
+        spread += d * d;
+    }
+    e.missRateError = 0;
+    if(e.units > 1){
+        double mean = double(e.measured) / e.units;
+        double population = (samplingMode == SAMPLE_SETS) ? double(c_set)
+                                                          : double(sampleTotal) / sampleDetail;
+        double fpc = (population > e.units) ? 1.0 - e.units / population : 0.0;
+        e.missRateError = Z_95 * sqrt(fpc * spread / (e.units - 1) / e.units) / mean;
+    }
+
+    unsigned long long evictions = sampleEvict;
+    unsigned long long memoryWrites = sampleMemWrite;
+    if(samplingMode == SAMPLE_SETS){
+        evictions = numEvict;
+        memoryWrites = numMemWrite;
+    }
+    else if(windowOpen){
+        evictions += numEvict - windowEvict;
+        memoryWrites += numMemWrite - windowMemWrite;
+    }
+    double scale = e.measured ? double(e.accesses) / double(e.measured) : 0.0;
+    e.misses = e.missRate * e.accesses;
+    e.evictions = evictions * scale;
+    e.memoryWrites = memoryWrites * scale;
+    e.amat = hitTime + e.missRate * missPenalty;
+    return e;
+}
@@ -0,0 +1,167 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#include "stack_distance.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+#define MIN_TIMESTAMPS (1u << 16) //smallest Fenwick tree kept after renumbering
+
+stack_profiler::stack_profiler(unsigned line_size,
+                               const vector<unsigned> &set_counts,
+                               unsigned max_ways){
+    blkoffBits = log2(line_size);
+    numAccesses = 0;
+    numCompulsory = 0;
+
+    tree.assign(MIN_TIMESTAMPS + 1, 0);
+    now = 1;
+
+    maxWays = (max_ways > 255) ? 255 : max_ways;
+    //the set index is taken with a mask, so only powers of two can be profiled
+    for(unsigned i = 0; i < set_counts.size(); i++){
+        if(set_counts[i] != 0 && (set_counts[i] & (set_counts[i] - 1)) == 0) setCounts.push_back(set_counts[i]);
+    }
+    for(unsigned i = 0; i < setCounts.size(); i++){
+        setStacks.push_back(vector<long long>((size_t)setCounts[i] * maxWays));
+        setDepths.push_back(vector<unsigned char>(setCounts[i], 0));
+        setDistances.push_back(vector<unsigned long long>(maxWays + 1, 0));
+    }
+}
+
+void stack_profiler::mark(unsigned t, int delta){
+    for(; t < tree.size(); t += t & (0 - t)) tree[t] += delta;
+}
+
+unsigned stack_profiler::prefix(unsigned t) const{
+    unsigned sum = 0;
+    for(; t > 0; t -= t & (0 - t)) sum += tree[t];
+    return sum;
+}
+
+void stack_profiler::compact(){
+    //renumber the live blocks 1..n in access order and rebuild the tree around them
+    vector<pair<unsigned, long long> > live;
+    live.reserve(lastAccess.size());
+    for(unordered_map<long long, unsigned>::iterator it = lastAccess.begin(); it != lastAccess.end(); ++it){
+        live.push_back(make_pair(it->second, it->first));
+    }
+    sort(live.begin(), live.end());
+
+    size_t capacity = max((size_t)MIN_TIMESTAMPS, 2 * live.size());
+    tree.assign(capacity + 1, 0);
+    for(unsigned i = 0; i < live.size(); i++){
+        lastAccess[live[i].second] = i + 1;
+        tree[i + 1] = 1;
+    }
+    //linear Fenwick build from the marks
+    for(unsigned t = 1; t <= capacity; t++){
+        unsigned parent = t + (t & (0 - t));
+        if(parent <= capacity) tree[parent] += tree[t];
+    }
+    now = live.size() + 1;
+}
+
+void stack_profiler::access(address_t address){
+    long long block = address >> blkoffBits;
+    numAccesses++;
+
+    if(now == tree.size()) compact();
+
+    unordered_map<long long, unsigned>::iterator it = lastAccess.find(block);
+    if(it == lastAccess.end()){
+        numCompulsory++;
+        lastAccess[block] = now;
+    }
+    else{
+        unsigned distance = prefix(now - 1) - prefix(it->second);
+        if(distance >= distances.size()) distances.resize(distance + 1, 0);
+        distances[distance]++;
+        mark(it->second, -1);
+        it->second = now;
+    }
+    mark(now, 1);
+    now++;
+
+    if(!setCounts.empty()) access_sets(block);
+}
+
+void stack_profiler::access_sets(long long block){
+    for(unsigned s = 0; s < setCounts.size(); s++){
+        unsigned set = (unsigned)(block & (setCounts[s] - 1));
+        long long *stack = &setStacks[s][(size_t)set * maxWays];
+        unsigned depth = setDepths[s][set];
+
+        unsigned d = 0;
+        while(d < depth && stack[d] != block) d++;
+        setDistances[s][d < depth ? d : maxWays]++;
+
+        //move (or push) the block to the top of the stack, dropping the bottom if full
+        if(d == depth){
+            if(depth < maxWays) setDepths[s][set] = depth + 1;
+            else d = maxWays - 1;
+        }
+        for(; d > 0; d--) stack[d] = stack[d - 1];
+        stack[0] = block;
+    }
+}
+
+bool stack_profiler::run(const char *filename, trace_format_t format){
+    trace_reader trace;
+    if(!trace.open(filename, format)) return false;
+
+    char op;
+    address_t address;
+    while(trace.next(op, address)){
+        if(op == 'r' || op == 'w') access(address);
+    }
+    return true;
+}
+
+unsigned long long stack_profiler::misses(unsigned long long blocks) const{
+    unsigned long long total = numCompulsory;
+    for(unsigned long long d = blocks; d < distances.size(); d++) total += distances[d];
+    return total;
+}
+
+unsigned long long stack_profiler::misses(unsigned sets, unsigned ways) const{
+    unsigned s = 0;
+    while(s < setCounts.size() && setCounts[s] != sets) s++;
+    if(s == setCounts.size() || ways == 0 || ways > maxWays) return numAccesses;
+
+    unsigned long long total = 0;
+    for(unsigned d = ways; d <= maxWays; d++) total += setDistances[s][d];
+    return total;
+}
+
+//miss ratio, 0 for an empty profile
+static double ratio(unsigned long long misses, unsigned long long accesses){
+    return accesses ? double(misses) / double(accesses) : 0.0;
+}
+
+void stack_profiler::print_miss_ratio_curve(){
+    unsigned blockSize = 1u << blkoffBits;
+
+    cout << "MISS RATIO CURVE (fully-associative LRU, " << dec << blockSize << " B lines)" << endl;
+    cout << setfill(' ') << setw(12) << "size (B)" << setw(12) << "misses" << setw(12) << "miss ratio" << endl;
+    unsigned long long blocks = 1;
+    for(;;){
+        unsigned long long m = misses(blocks);
+        cout << setw(12) << blocks * blockSize << setw(12) << m << setw(12) << ratio(m, numAccesses) << endl;
+        if(m == numCompulsory) break;
+        blocks *= 2;
+    }
+
+    for(unsigned s = 0; s < setCounts.size(); s++){
+        cout << endl << "MISS RATIO CURVE (" << setCounts[s] << " sets)" << endl;
+        cout << setw(12) << "size (B)" << setw(6) << "ways" << setw(12) << "misses" << setw(12) << "miss ratio" << endl;
+        for(unsigned ways = 1; ways <= maxWays; ways *= 2){
+            unsigned long long m = misses(setCounts[s], ways);
+            cout << setw(12) << (unsigned long long)setCounts[s] * ways * blockSize << setw(6) << ways
+                 << setw(12) << m << setw(12) << ratio(m, numAccesses) << endl;
+        }
+    }
+}
@@ -0,0 +1,74 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#ifndef STACK_DISTANCE_H_
+#define STACK_DISTANCE_H_
+
+#include "cache.h"
+#include <unordered_map>
+
+//Mattson stack-distance profiler: one pass over a trace gives the number of
+//misses of an LRU cache of every size at one line size.
+//
+//The fully-associative stack distance of an access is the number of distinct
+//blocks touched since the previous access to the same block. It is found in
+//O(log n) with a Fenwick tree that marks the latest access time of every live
+//block; timestamps are renumbered whenever the tree fills up.
+//
+//For set-associative caches, each requested set count keeps a per-set LRU
+//stack truncated to "max_ways" entries, so misses can be read off for any
+//associativity up to that bound.
+//
+//Every access allocates, so the curves match write-allocate caches.
+class stack_profiler{
+    unsigned blkoffBits;
+    unsigned long long numAccesses;
+    unsigned long long numCompulsory;
+
+    //fully-associative profile
+    unordered_map<long long, unsigned> lastAccess; //block -> timestamp of its latest access
+    vector<unsigned> tree;                         //Fenwick tree over timestamps, 1-based
+    unsigned now;                                  //next timestamp
+    vector<unsigned long long> distances;          //histogram of stack distances
+
+    //set-associative profiles, one per set count
+    unsigned maxWays;
+    vector<unsigned> setCounts;
+    vector<vector<long long> > setStacks;          //[set*maxWays + depth], most recent first
+    vector<vector<unsigned char> > setDepths;      //valid entries in each set's stack
+    vector<vector<unsigned long long> > setDistances; //histogram, [maxWays] counts deeper or new blocks
+
+    void mark(unsigned t, int delta);
+    unsigned prefix(unsigned t) const;
+    void compact();
+    void access_sets(long long block);
+
+public:
+    // "set_counts" lists the set counts (powers of two) to profile as set-associative caches;
+    // other counts are left out, so misses() treats them as unprofiled
+    stack_profiler(unsigned line_size,
+                   const vector<unsigned> &set_counts=vector<unsigned>(),
+                   unsigned max_ways=64);
+
+    // profiles one memory access
+    void access(address_t address);
+
+    // profiles a whole trace; returns false if it cannot be read
+    bool run(const char *filename, trace_format_t format=TRACE_AUTO);
+
+    unsigned long long accesses() const { return numAccesses; }
+    unsigned long long compulsory_misses() const { return numCompulsory; }
+
+    // misses of a fully-associative LRU cache holding "blocks" lines
+    unsigned long long misses(unsigned long long blocks) const;
+
+    // misses of an LRU cache with "sets" sets (one of "set_counts") and "ways" ways (at most "max_ways")
+    unsigned long long misses(unsigned sets, unsigned ways) const;
+
+    // prints the miss-ratio curves for power-of-two cache sizes
+    void print_miss_ratio_curve();
+};
+
+#endif /*STACK_DISTANCE_H_*/
@@ -0,0 +1,145 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#include "sweep.h"
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#define SWEEP_BATCH 4096 //trace entries decoded per batch
+
+cache_sweep::cache_sweep(const vector<cache_config_t> &configurations,
+                         unsigned hit_time,
+                         unsigned miss_penalty,
+                         unsigned address_width){
+    configs = configurations;
+    for(unsigned i = 0; i < configs.size(); i++){
+        cache *c = new cache(configs[i].size,
+                             configs[i].associativity,
+                             configs[i].line_size,
+                             configs[i].write_hit_policy,
+                             configs[i].write_miss_policy,
+                             hit_time,
+                             miss_penalty,
+                             address_width,
+                             configs[i].replacement);
+        caches.push_back(c);
+
+        unsigned g = 0;
+        while(g < groups.size() && groupOffsetBits[g] != c->blkoffBits) g++;
+        if(g == groups.size()){
+            groupOffsetBits.push_back(c->blkoffBits);
+            groups.push_back(vector<cache *>());
+        }
+        groups[g].push_back(c);
+    }
+}
+
+cache_sweep::~cache_sweep(){
+    for(unsigned i = 0; i < caches.size(); i++) delete caches[i];
+}
+
+bool cache_sweep::run(const char *filename, trace_format_t format){
+    trace_reader trace;
+    if(!trace.open(filename, format)) return false;
+    replay_trace(trace, groupOffsetBits, groups);
+    return true;
+}
+
+bool cache_sweep::run_parallel(const char *filename, unsigned threads, trace_format_t format){
+    trace_reader trace;
+    if(!trace.open(filename, format)) return false;
+
+    if(threads == 0) threads = thread::hardware_concurrency();
+    if(threads == 0) threads = 1;
+
+    //split every line-size group into chunks, roughly one chunk per thread overall,
+    //so caches in a chunk still share the decoding of each batch
+    vector<unsigned> taskOffsetBits;
+    vector<vector<cache *> > tasks;
+    for(unsigned g = 0; g < groups.size(); g++){
+        unsigned chunks = (threads * groups[g].size() + caches.size() - 1) / caches.size();
+        unsigned per = (groups[g].size() + chunks - 1) / chunks;
+        for(unsigned k = 0; k < groups[g].size(); k += per){
+            taskOffsetBits.push_back(groupOffsetBits[g]);
+            tasks.push_back(vector<cache *>(groups[g].begin() + k,
+                                            groups[g].begin() + min<size_t>(k + per, groups[g].size())));
+        }
+    }
+
+    //each cache belongs to exactly one task, so workers never share simulator state
+    atomic<unsigned> nextTask(0);
+    vector<thread> workers;
+    for(unsigned t = 0; t < threads && t < tasks.size(); t++){
+        workers.push_back(thread([&](){
+            trace_reader view;
+            for(unsigned task = nextTask++; task < tasks.size(); task = nextTask++){
+                view.share(trace);
+                replay_trace(view, vector<unsigned>(1, taskOffsetBits[task]),
+                             vector<vector<cache *> >(1, tasks[task]));
+            }
+        }));
+    }
+    for(unsigned t = 0; t < workers.size(); t++) workers[t].join();
+    return true;
+}
+
+void cache_sweep::replay_trace(trace_reader &trace,
+                               const vector<unsigned> &offsetBits,
+                               const vector<vector<cache *> > &cacheGroups){
+    vector<char> ops(SWEEP_BATCH);
+    vector<long long> addresses(SWEEP_BATCH);
+    vector<long long> blocks(SWEEP_BATCH);
+
+    for(;;){
+        unsigned count = 0;
+        while(count < SWEEP_BATCH && trace.next(ops[count], addresses[count])) count++;
+        if(count == 0) break;
+
+        for(unsigned g = 0; g < cacheGroups.size(); g++){
+            unsigned shift = offsetBits[g];
+            for(unsigned i = 0; i < count; i++) blocks[i] = addresses[i] >> shift;
+            for(unsigned k = 0; k < cacheGroups[g].size(); k++){
+                cacheGroups[g][k]->replay(&ops[0], &blocks[0], count);
+            }
+        }
+    }
+}
+
+vector<sweep_result_t> cache_sweep::results(){
+    vector<sweep_result_t> table;
+    for(unsigned i = 0; i < caches.size(); i++){
+        cache *c = caches[i];
+        sweep_result_t r;
+        r.config = configs[i];
+        r.stats = c->statistics();
+        table.push_back(r);
+    }
+    return table;
+}
+
+void cache_sweep::print_results(){
+    vector<sweep_result_t> table = results();
+
+    cout << "SWEEP RESULTS" << endl;
+    cout << setfill(' ') << setw(8) << "size" << setw(6) << "ways" << setw(6) << "line"
+         << setw(4) << "hit" << setw(5) << "miss" << setw(11) << "policy"
+         << setw(11) << "accesses" << setw(11) << "reads" << setw(11) << "rd-misses"
+         << setw(11) << "writes" << setw(11) << "wr-misses" << setw(11) << "evictions"
+         << setw(11) << "mem-writes" << setw(10) << "AMAT" << endl;
+    for(unsigned i = 0; i < table.size(); i++){
+        const sweep_result_t &r = table[i];
+        cout << dec << setw(6) << (r.config.size / 1024) << "KB"
+             << setw(6) << r.config.associativity
+             << setw(6) << r.config.line_size
+             << setw(4) << (r.config.write_hit_policy == WRITE_BACK ? "WB" : "WT")
+             << setw(5) << (r.config.write_miss_policy == WRITE_ALLOCATE ? "WA" : "NWA")
+             << setw(11) << replacement_policy_name(r.config.replacement)
+             << setw(11) << r.stats.accesses << setw(11) << r.stats.reads << setw(11) << r.stats.readMisses
+             << setw(11) << r.stats.writes << setw(11) << r.stats.writeMisses << setw(11) << r.stats.evictions
+             << setw(11) << r.stats.memoryWrites << setw(10) << float(r.stats.amat) << endl;
+    }
+}
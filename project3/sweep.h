@@ -0,0 +1,70 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#ifndef SWEEP_H_
+#define SWEEP_H_
+
+#include "cache.h"
+
+//one point of a design-space sweep
+typedef struct{
+    unsigned size;                      // cache size (in bytes)
+    unsigned associativity;
+    unsigned line_size;                 // cache block size (in bytes)
+    write_policy_t write_hit_policy;    // write-back or write-through
+    write_policy_t write_miss_policy;   // write-allocate or no-write-allocate
+    replacement_policy_t replacement;   // LRU when left out of an initializer
+} cache_config_t;
+
+//statistics of one configuration after the sweep
+typedef struct{
+    cache_config_t config;
+    cache_stats_t stats;
+} sweep_result_t;
+
+//Simulates many cache configurations from a single pass over a trace.
+//Entries are read in batches; each batch is decoded once per distinct
+//line size and then replayed through every cache sharing that line size.
+//run_parallel() instead shards the caches across worker threads that all
+//read the same memory-mapped trace.
+class cache_sweep{
+    vector<cache_config_t> configs;
+    vector<cache *> caches;
+
+    //caches grouped by block offset bits, so block addresses are computed once per group
+    vector<unsigned> groupOffsetBits;
+    vector<vector<cache *> > groups;
+
+    cache_sweep(const cache_sweep &);
+    cache_sweep &operator=(const cache_sweep &);
+
+    // replays the rest of "trace" through every group of caches
+    static void replay_trace(trace_reader &trace,
+                             const vector<unsigned> &offsetBits,
+                             const vector<vector<cache *> > &cacheGroups);
+
+public:
+    cache_sweep(const vector<cache_config_t> &configurations,
+                unsigned cache_hit_time,        // cache hit time (in clock cycles)
+                unsigned cache_miss_penalty,    // cache miss penalty (in clock cycles)
+                unsigned address_width          // number of bits in memory address
+    );
+    ~cache_sweep();
+
+    // runs the whole trace (with name "filename") through every configuration; returns false if it cannot be read
+    bool run(const char *filename, trace_format_t format=TRACE_AUTO);
+
+    // same as run(), spread over "threads" worker threads (0 = one per hardware thread);
+    // results do not depend on the number of threads
+    bool run_parallel(const char *filename, unsigned threads=0, trace_format_t format=TRACE_AUTO);
+
+    // returns the statistics of every configuration, in the order they were given
+    vector<sweep_result_t> results();
+
+    // prints the results as one table, a row per configuration
+    void print_results();
+};
+
+#endif /*SWEEP_H_*/
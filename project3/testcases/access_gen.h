@@ -0,0 +1,44 @@
+#ifndef ACCESS_GEN_H
+#define ACCESS_GEN_H
+
+#include "cache.h"
+#include <iostream>
+
+/* Shared by the testcases: a fixed pseudo-random access stream, so a run needs no trace file,
+   and checks of counts derived by hand */
+
+//64-bit linear congruential generator; every testcase starts from the same seed
+class access_gen{
+public:
+	access_gen() : state(12345) {}
+
+	//moves on to the next access
+	void next(){ state = state * 6364136223846793005ULL + 1442695040888963407ULL; }
+
+	//an offset below "footprint" bytes
+	address_t offset(unsigned long long footprint) const { return (state >> 33) % footprint; }
+
+	//a write for a quarter of the accesses, a read otherwise
+	char op() const { return (state >> 62) == 0 ? 'w' : 'r'; }
+
+	//the state from bit "shift" up, for picking regions, cores and sizes
+	unsigned long long bits(unsigned shift) const { return state >> shift; }
+
+private:
+	unsigned long long state;
+};
+
+static unsigned failed_checks = 0;
+
+//prints "what = value", adding the expected value and counting a failure when they differ;
+//main returns failed_checks != 0 so that ctest reports it
+static inline void expect(const char *what, unsigned long long value, unsigned long long expected){
+	std::cout << what << " = " << value;
+	if (value != expected){
+		std::cout << " (expected " << expected << ")";
+		failed_checks++;
+	}
+	std::cout << std::endl;
+}
+
+#endif
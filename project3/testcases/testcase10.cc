@@ -0,0 +1,78 @@
+#include "cache.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: prefetchers on sequential, strided and random accesses */
+
+//interleaves a sequential walk, a strided walk and random accesses
+static void run_accesses(cache *c, unsigned count){
+	access_gen gen;
+	address_t sequential = 0x100000, strided = 0x400000;
+	for (unsigned i=0; i<count; i++){
+		gen.next();
+		address_t address;
+		switch (gen.bits(60) & 3){
+			case 0:
+			case 1: address = sequential; sequential += 8; break;
+			case 2: address = strided; strided += 320; break;
+			default: address = gen.offset(256*KB); break;
+		}
+		c->access(address, gen.op());
+	}
+}
+
+//reads the 64-byte blocks "blocks" through an 8-set direct-mapped cache with a next-line prefetcher
+static cache_stats_t read_blocks(const long long *blocks, unsigned count){
+	cache c(512, 1, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	c.set_prefetcher(PREFETCH_NEXT_LINE, 1);
+	for (unsigned i=0; i<count; i++) c.access(blocks[i] * 64, 'r');
+	return c.statistics();
+}
+
+int main(int argc, char **argv){
+
+	//2 prefetches 3; 11 replaces 3 with a demand fill and prefetches 12; 3 prefetches 4 over 12:
+	//no prefetch threw out a block that was then missed on
+	long long clean[] = {2, 11, 3};
+	cache_stats_t s = read_blocks(clean, 3);
+	expect("prefetches", s.prefetches, 3);
+	expect("polluting prefetches", s.pollutingPrefetches, 0);
+
+	//10 prefetches 11; 1 prefetches 2, which throws out 10; the miss on 10 is the prefetch's doing
+	long long polluted[] = {10, 1, 10};
+	s = read_blocks(polluted, 3);
+	expect("prefetches", s.prefetches, 2);
+	expect("polluting prefetches", s.pollutingPrefetches, 1);
+	cout << endl;
+
+	prefetch_policy_t policies[] = {PREFETCH_NONE, PREFETCH_NEXT_LINE, PREFETCH_STRIDE, PREFETCH_STREAM, PREFETCH_SPATIAL};
+
+	for (unsigned p=0; p<5; p++){
+
+		cache *mycache = new cache(16*KB,	//size
+				  4,			//associativity
+				  64,			//cache line size
+				  WRITE_BACK,		//write hit policy
+				  WRITE_ALLOCATE,	//write miss policy
+				  5,			//hit time
+				  100,			//miss penalty
+				  32			//address width
+				  );
+		mycache->set_prefetcher(policies[p], 2);
+
+		mycache->print_configuration();
+		run_accesses(mycache, 60000);
+		cout << endl;
+		mycache->print_statistics();
+		cout << endl;
+
+		delete mycache;
+	}
+	return failed_checks != 0;
+}
@@ -0,0 +1,74 @@
+#include "cache.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: sectored lines */
+
+//fixed pseudo-random accesses of 4 to 64 bytes over "footprint" bytes
+static void run_accesses(cache *c, unsigned count, unsigned footprint){
+	access_gen gen;
+	for (unsigned i=0; i<count; i++){
+		gen.next();
+		c->access(gen.offset(footprint) & ~3u, gen.op(), 4u << (gen.bits(28) & 3));
+	}
+}
+
+int main(int argc, char **argv){
+
+	//one 128-byte line of four 32-byte sectors: the read of 0x20 finds the line without its sector,
+	//the write dirties sector 0 only, and the line at 0x80 writes back just that sector
+	cache *mycache = new cache(128, 1, 128, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	mycache->set_sectors(4);
+	mycache->access(0x0, 'r', 4);
+	mycache->access(0x20, 'r', 4);
+	mycache->access(0x10, 'w', 4);
+	mycache->access(0x0, 'r', 4);
+	mycache->access(0x80, 'r', 4);
+	cache_stats_t s = mycache->statistics();
+	expect("read misses", s.readMisses, 3);
+	expect("sector misses", s.sectorMisses, 1);
+	expect("write misses", s.writeMisses, 0);
+	expect("evictions", s.evictions, 1);
+	expect("bytes filled", s.bytesFill, 3*32);
+	expect("bytes written back", s.bytesWriteback, 32);
+	cout << endl;
+	delete mycache;
+
+	write_policy_t hit[] = {WRITE_BACK, WRITE_THROUGH};
+	write_policy_t miss[] = {WRITE_ALLOCATE, NO_WRITE_ALLOCATE};
+
+	for (unsigned w=0; w<2; w++){
+		for (unsigned s=1; s<=8; s=s*2){
+
+			cout << "SECTORS = " << s << endl;
+			cout << "===================" << endl << endl;
+
+			mycache = new cache(16*KB,	//size
+					  4,			//associativity
+					  128,			//cache line size
+					  hit[w],		//write hit policy
+					  miss[w],		//write miss policy
+					  5,			//hit time
+					  100,			//miss penalty
+					  32			//address width
+					  );
+			mycache->set_sectors(s);
+			mycache->report_traffic();
+
+			mycache->print_configuration();
+			run_accesses(mycache, 40000, 48*KB);
+			cout << endl;
+			mycache->print_statistics();
+			cout << endl;
+
+			delete mycache;
+		}
+	}
+	return failed_checks != 0;
+}
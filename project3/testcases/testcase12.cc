@@ -0,0 +1,83 @@
+#include "cache.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: memory traffic and bandwidth-limited memory */
+
+//fixed pseudo-random accesses over "footprint" bytes
+static void run_accesses(cache *c, unsigned count, unsigned footprint){
+	access_gen gen;
+	for (unsigned i=0; i<count; i++){
+		gen.next();
+		c->access(gen.offset(footprint), gen.op());
+	}
+}
+
+int main(int argc, char **argv){
+
+	//two direct-mapped 64-byte lines and a memory moving one byte per cycle (hit time 5, miss
+	//penalty 100): the first two fills find the channel free, but the dirty 0x40 is written back
+	//when 0xc0 replaces it, and the fill queued behind that writeback waits its 64 cycles
+	cache *mycache = new cache(128, 1, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	mycache->set_memory_bandwidth(1);
+	mycache->access(0x0, 'r');
+	mycache->access(0x40, 'r');
+	mycache->access(0x40, 'w');
+	mycache->access(0xc0, 'r');
+	cache_stats_t s = mycache->statistics();
+	expect("bytes filled", s.bytesFill, 3*64);
+	expect("bytes written back", s.bytesWriteback, 64);
+	expect("stall cycles", s.stallCycles, 64);
+	delete mycache;
+
+	//write-through without write-allocate: the write miss and the write hit each send their 8 bytes
+	mycache = new cache(128, 1, 64, WRITE_THROUGH, NO_WRITE_ALLOCATE, 5, 100, 32);
+	mycache->access(0x0, 'w', 8);
+	mycache->access(0x0, 'r');
+	mycache->access(0x0, 'w', 8);
+	s = mycache->statistics();
+	expect("bytes filled", s.bytesFill, 64);
+	expect("bytes written through", s.bytesWriteThrough, 2*8);
+	expect("memory writes", s.memoryWrites, 2);
+	cout << endl;
+	delete mycache;
+
+	write_policy_t hit[] = {WRITE_BACK, WRITE_THROUGH};
+	write_policy_t miss[] = {WRITE_ALLOCATE, NO_WRITE_ALLOCATE};
+	double bandwidth[] = {0, 16, 4, 1};
+
+	for (unsigned w=0; w<2; w++){
+		for (unsigned b=0; b<4; b++){
+
+			cout << "BYTES PER CYCLE = " << bandwidth[b] << endl;
+			cout << "===================" << endl << endl;
+
+			mycache = new cache(16*KB,	//size
+					  4,			//associativity
+					  64,			//cache line size
+					  hit[w],		//write hit policy
+					  miss[w],		//write miss policy
+					  5,			//hit time
+					  100,			//miss penalty
+					  32			//address width
+					  );
+			mycache->report_traffic();
+			mycache->set_memory_bandwidth(bandwidth[b]);
+
+			mycache->print_configuration();
+			run_accesses(mycache, 40000, 24*KB);
+			cout << endl;
+			mycache->print_statistics();
+			cout << endl;
+
+			delete mycache;
+		}
+	}
+	return failed_checks != 0;
+}
@@ -0,0 +1,80 @@
+#include "cache.h"
+#include "classify.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: compulsory, capacity and conflict miss classification */
+
+//fixed pseudo-random accesses, half of them to a region that fits the cache and half to one
+//that does not, with a power-of-two stride that piles onto a few sets
+static void run_accesses(cache *c, unsigned count){
+	access_gen gen;
+	for (unsigned i=0; i<count; i++){
+		gen.next();
+		address_t address;
+		switch (gen.bits(60) & 3){
+			case 0:
+			case 1: address = gen.offset(6*KB); break;
+			case 2: address = 0x100000 + gen.offset(16) * 8*KB; break;
+			default: address = 0x200000 + gen.offset(64*KB); break;
+		}
+		c->access(address, gen.op());
+	}
+}
+
+int main(int argc, char **argv){
+
+	//blocks 0 2 0 4 6 0 2 through a two-line direct-mapped cache, where the even blocks all share
+	//set 0 and every access misses: the second 0 is a conflict miss (a two-line fully-associative
+	//cache still holds 0 and 2), the third one a capacity miss (it holds 4 and 6 by then),
+	//and the last 2 a capacity miss too
+	miss_classifier classifier(2);
+	long long blocks[] = {0, 2, 0, 4, 6, 0, 2};
+	miss_class_t classes[] = {MISS_COMPULSORY, MISS_COMPULSORY, MISS_CONFLICT, MISS_COMPULSORY, MISS_COMPULSORY,
+	                          MISS_CAPACITY, MISS_CAPACITY};
+	for (unsigned i=0; i<7; i++){
+		expect("class", classifier.classify(blocks[i], true, true), classes[i]);
+	}
+	//a hit is not classified, but still moves 2 to the front of the shadow cache,
+	//so the fill of 4 that follows pushes 0 out of it instead
+	expect("class of a hit", classifier.classify(2, false, true), MISS_NONE);
+	expect("class", classifier.classify(4, true, true), MISS_CAPACITY);
+	expect("class", classifier.classify(2, true, true), MISS_CONFLICT);
+	expect("compulsory misses", classifier.numCompulsory, 4);
+	expect("capacity misses", classifier.numCapacity, 3);
+	expect("conflict misses", classifier.numConflict, 2);
+	cout << endl;
+
+	unsigned ways[] = {1, 2, 8, 128, 8};
+	replacement_policy_t policies[] = {REPLACE_LRU, REPLACE_LRU, REPLACE_LRU, REPLACE_LRU, REPLACE_FIFO};
+
+	for (unsigned w=0; w<5; w++){
+
+		cache *mycache = new cache(8*KB,	//size
+				  ways[w],		//associativity
+				  64,			//cache line size
+				  WRITE_BACK,		//write hit policy
+				  WRITE_ALLOCATE,	//write miss policy
+				  5,			//hit time
+				  100,			//miss penalty
+				  32,			//address width
+				  policies[w]		//replacement policy
+				  );
+		mycache->set_miss_classification();
+
+		mycache->print_configuration();
+		run_accesses(mycache, 40000);
+		cout << endl;
+		mycache->print_statistics();
+		cout << endl;
+
+		delete mycache;
+	}
+	return failed_checks != 0;
+}
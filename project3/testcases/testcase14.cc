@@ -0,0 +1,104 @@
+#include "cache.h"
+#include "tlb.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+#define KB 1024
+#define MB (1024*KB)
+
+using namespace std;
+
+/* Test case for cache simulator: address translation through a TLB hierarchy */
+
+//fixed pseudo-random accesses, most of them to a few pages and the rest over 64 MB,
+//so the run needs no trace file
+static void run_accesses(cache *c, unsigned count){
+	access_gen gen;
+	for (unsigned i=0; i<count; i++){
+		gen.next();
+		c->access(0x10000000 + gen.offset((gen.bits(60) & 3) ? 32*KB : 64*MB), gen.op());
+	}
+}
+
+static tlb_hierarchy *make_tlbs(bool huge_pages){
+	tlb_hierarchy *tlbs = new tlb_hierarchy(20);	//walk latency
+	tlbs->add_level(16, 4, 1);			//entries, associativity, hit time
+	tlbs->add_level(256, 8, 7);
+	if (huge_pages) tlbs->map_huge_pages(0x10000000, 64*MB, 2*MB);
+	return tlbs;
+}
+
+//virtual addresses of the hand-checked sequence: pages 1, 5, 1, 9, 5 and 1 of 4 KB
+static const long long sequence[] = {0x1234, 0x5678, 0x1010, 0x9000, 0x5000, 0x1fff};
+
+int main(int argc, char **argv){
+
+	//one 2-entry, fully associative TLB (hit time 1) over 4 KB pages and a 20-cycle walk
+	//of 4 levels: the first touches of pages 1, 5 and 9 get frames 0, 0x1000 and 0x2000,
+	//page 9 evicts page 5, which then evicts page 1, so only the third translation hits
+	tlb_hierarchy *tlbs = new tlb_hierarchy(20);
+	tlbs->add_level(2, 2, 1);
+	long long physical[] = {0x234, 0x1678, 0x010, 0x2000, 0x1000, 0xfff};
+	unsigned latencies[] = {81, 81, 1, 81, 81, 81};
+	for (unsigned i=0; i<6; i++){
+		unsigned latency = 0;
+		expect("physical address", tlbs->translate(sequence[i], latency), physical[i]);
+		expect("  latency", latency, latencies[i]);
+	}
+	delete tlbs;
+
+	//a 2 MB page walks 3 levels and takes a 2 MB aligned frame, past the 4 KB page mapped first
+	tlbs = new tlb_hierarchy(20);
+	tlbs->add_level(2, 2, 1);
+	tlbs->map_huge_pages(0x200000, 2*MB, 2*MB);
+	unsigned latency = 0;
+	expect("physical address", tlbs->translate(0x3000, latency), 0x0);
+	latency = 0;
+	expect("physical address", tlbs->translate(0x200010, latency), 0x200010);
+	expect("  latency", latency, 61);
+	delete tlbs;
+
+	//the cache counts the same 406 cycles, less the TLB hit time it hides when virtually indexed
+	for (unsigned v=0; v<2; v++){
+		cache *c = new cache(32*KB, 4, 64, WRITE_BACK, WRITE_ALLOCATE, 2, 100, 32);
+		tlbs = new tlb_hierarchy(20);
+		tlbs->add_level(2, 2, 1);
+		c->set_translation(tlbs, v == 1);
+		for (unsigned i=0; i<6; i++) c->access(sequence[i], 'r');
+		expect(v ? "translation cycles (virtually indexed)" : "translation cycles", c->statistics().translationCycles, v ? 400 : 406);
+		delete c;
+	}
+	cout << endl;
+
+	const char *names[] = {"PHYSICALLY INDEXED", "PHYSICALLY INDEXED, 2 MB PAGES", "VIRTUALLY INDEXED (16 KB)",
+	                       "VIRTUALLY INDEXED (32 KB)"};
+	unsigned sizes[] = {32*KB, 32*KB, 16*KB, 32*KB};
+
+	for (unsigned t=0; t<4; t++){
+
+		cout << names[t] << endl;
+		cout << "===================" << endl << endl;
+
+		cache *mycache = new cache(sizes[t],	//size
+				  4,			//associativity
+				  64,			//cache line size
+				  WRITE_BACK,		//write hit policy
+				  WRITE_ALLOCATE,	//write miss policy
+				  2,			//hit time
+				  100,			//miss penalty
+				  32			//address width
+				  );
+		mycache->set_translation(make_tlbs(t == 1), t >= 2);
+
+		mycache->print_configuration();
+		run_accesses(mycache, 40000);
+		cout << endl;
+		mycache->print_statistics();
+		cout << endl;
+
+		delete mycache;
+	}
+	return failed_checks != 0;
+}
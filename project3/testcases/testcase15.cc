@@ -0,0 +1,102 @@
+#include "cache.h"
+#include "access_gen.h"
+#include "le_bytes.h"
+#include <iostream>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: interval statistics logs */
+
+#define CSV_FILE "testcase15.csv"
+#define BINARY_FILE "testcase15.log"
+
+//one set of two ways with intervals of 4 accesses, accessing 64-byte blocks
+//  r A, r B, r A, r C   4 reads, 3 misses, C evicts B
+//  w A, w D, w B, r D   A hits, D evicts C, B evicts the dirty A, D hits
+//  r C                  a partial interval, logged when logging stops: C evicts the dirty B
+static const interval_sample_t expected[] = {
+	{4, 4, 3, 0, 0, 1, 0},
+	{8, 1, 0, 3, 2, 2, 1},
+	{9, 1, 1, 0, 0, 1, 1},
+};
+
+static void log_accesses(const char *filename, interval_format_t format){
+	cache c(128, 2, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	cout << "open = " << c.set_interval_stats(4, filename, format) << endl;
+	const char *ops = "rrrrwwwrr", *blocks = "ABACADBDC";
+	for (unsigned i=0; ops[i]; i++) c.access((blocks[i] - 'A') * 64, ops[i]);
+	c.set_interval_stats(0);
+}
+
+static void check(const interval_sample_t &s, const interval_sample_t &e){
+	expect("  access", s.end, e.end);
+	expect("  reads", s.reads, e.reads);
+	expect("  read misses", s.readMisses, e.readMisses);
+	expect("  writes", s.writes, e.writes);
+	expect("  write misses", s.writeMisses, e.writeMisses);
+	expect("  evictions", s.evictions, e.evictions);
+	expect("  memory writes", s.memoryWrites, e.memoryWrites);
+}
+
+int main(int argc, char **argv){
+
+	cout << "CSV LOG" << endl;
+	log_accesses(CSV_FILE, INTERVAL_CSV);
+	FILE *f = fopen(CSV_FILE, "r");
+	char line[256];
+	cout << (fgets(line, sizeof(line), f) ? line : "no header\n");
+	unsigned n = 0;
+	interval_sample_t s;
+	double missRate;
+	while (fgets(line, sizeof(line), f)){
+		cout << line;
+		sscanf(line, "%llu,%llu,%llu,%llu,%llu,%lf,%llu,%llu", &s.end, &s.reads, &s.readMisses, &s.writes,
+		       &s.writeMisses, &missRate, &s.evictions, &s.memoryWrites);
+		if (n < 3) check(s, expected[n]);
+		n++;
+	}
+	fclose(f);
+	expect("intervals", n, 3);
+	cout << endl;
+
+	cout << "BINARY LOG" << endl;
+	log_accesses(BINARY_FILE, INTERVAL_BINARY);
+	f = fopen(BINARY_FILE, "rb");
+	unsigned char header[INTERVAL_HEADER_SIZE], record[INTERVAL_FIELDS * 8];
+	if (fread(header, 1, INTERVAL_HEADER_SIZE, f) != INTERVAL_HEADER_SIZE) memset(header, 0, sizeof(header));
+	expect("magic", memcmp(header, INTERVAL_MAGIC, 4) == 0, 1);
+	expect("version", get_le(header + 4, 4), INTERVAL_VERSION);
+	expect("interval", get_le(header + 8, 8), 4);
+	n = 0;
+	while (fread(record, 1, sizeof(record), f) == sizeof(record)){
+		s.end = get_le(record, 8);
+		s.reads = get_le(record + 8, 8);
+		s.readMisses = get_le(record + 16, 8);
+		s.writes = get_le(record + 24, 8);
+		s.writeMisses = get_le(record + 32, 8);
+		s.evictions = get_le(record + 40, 8);
+		s.memoryWrites = get_le(record + 48, 8);
+		cout << "interval " << n << endl;
+		if (n < 3) check(s, expected[n]);
+		n++;
+	}
+	fclose(f);
+	expect("intervals", n, 3);
+	cout << endl;
+
+	//logging needs a file to log to
+	cache c(128, 2, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	expect("no file name", c.set_interval_stats(4), 0);
+	expect("no such directory", c.set_interval_stats(4, "no/such/directory.csv"), 0);
+	expect("logging off", c.set_interval_stats(0), 1);
+
+	remove(CSV_FILE);
+	remove(BINARY_FILE);
+	return failed_checks != 0;
+}
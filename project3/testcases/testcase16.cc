@@ -0,0 +1,107 @@
+#include "cache.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: set sampling and interval sampling */
+
+#define TRACE_FILE "testcase16.t"
+
+static void write_trace(const char *lines){
+	FILE *f = fopen(TRACE_FILE, "w");
+	fputs(lines, f);
+	fclose(f);
+}
+
+//writes "count" fixed pseudo-random accesses over "footprint" bytes
+static void write_random_trace(unsigned count, unsigned footprint){
+	FILE *f = fopen(TRACE_FILE, "w");
+	access_gen gen;
+	for (unsigned i=0; i<count; i++){
+		gen.next();
+		fprintf(f, "%c 0x%x\n", gen.op(), unsigned(gen.offset(footprint)));
+	}
+	fclose(f);
+}
+
+static void print_estimate(const sample_estimate_t &e){
+	cout << "accesses = " << e.accesses << ", measured = " << e.measured << ", units = " << e.units << endl;
+	cout << "miss rate = " << e.missRate << " +- " << e.missRateError << endl;
+	cout << "misses = " << e.misses << ", evictions = " << e.evictions << ", memory writes = " << e.memoryWrites << endl;
+}
+
+int main(int argc, char **argv){
+
+	//four direct-mapped sets, one in two sampled: blocks 0 1 2 3 0 4 put 0, 2, 0 and 4 in sets 0 and 2,
+	//three of them misses and 4 evicting 0; the estimate scales those four up to all six accesses
+	cout << "SET SAMPLING" << endl;
+	write_trace("r 0x0\nr 0x40\nr 0x80\nr 0xc0\nr 0x0\nr 0x100\n");
+	cache *mycache = new cache(256, 1, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	mycache->set_set_sampling(2);
+	mycache->load_trace(TRACE_FILE);
+	mycache->run();
+	sample_estimate_t e = mycache->sampling_estimate();
+	expect("accesses", e.accesses, 6);
+	expect("measured", e.measured, 4);
+	expect("sets", e.units, 2);
+	expect("misses x 100", (unsigned long long)(e.misses * 100 + 0.5), 450);
+	expect("evictions x 100", (unsigned long long)(e.evictions * 100 + 0.5), 150);
+	cout << endl;
+	delete mycache;
+
+	//periods of 4 accesses measuring the last 2, all misses; the instruction fetch ("i") lands on the last
+	//phase of the first period and must neither close its window early nor advance the period
+	cout << "INTERVAL SAMPLING" << endl;
+	write_trace("r 0x0\nr 0x40\nr 0x80\ni 0x0\nr 0xc0\nr 0x100\nr 0x140\ni 0x0\nr 0x180\nr 0x1c0\n");
+	mycache = new cache(16*KB, 4, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	mycache->set_interval_sampling(4, 2, 0);
+	mycache->load_trace(TRACE_FILE);
+	mycache->run();
+	e = mycache->sampling_estimate();
+	expect("accesses", e.accesses, 8);
+	expect("measured", e.measured, 4);
+	expect("windows", e.units, 2);
+	expect("misses", (unsigned long long)(e.misses + 0.5), 8);
+	cout << endl;
+	delete mycache;
+
+	//a random trace, with and without warm-up before the windows
+	write_random_trace(60000, 48*KB);
+	unsigned warmup[] = {0, 200};
+	for (unsigned w=0; w<2; w++){
+		cout << "INTERVAL SAMPLING, WARMUP = " << warmup[w] << endl;
+		mycache = new cache(16*KB, 4, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+		mycache->set_interval_sampling(2000, 200, warmup[w]);
+		mycache->load_trace(TRACE_FILE);
+		mycache->run();
+		print_estimate(mycache->sampling_estimate());
+		cout << endl;
+		delete mycache;
+	}
+
+	cout << "SET SAMPLING, ONE IN 8" << endl;
+	mycache = new cache(16*KB, 4, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	mycache->set_set_sampling(8);
+	mycache->load_trace(TRACE_FILE);
+	mycache->run();
+	print_estimate(mycache->sampling_estimate());
+	cout << endl;
+	delete mycache;
+
+	cout << "FULL RUN" << endl;
+	mycache = new cache(16*KB, 4, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	mycache->load_trace(TRACE_FILE);
+	mycache->run();
+	cache_stats_t s = mycache->statistics();
+	cout << "accesses = " << s.accesses << ", misses = " << s.readMisses + s.writeMisses << ", evictions = " << s.evictions << endl;
+	delete mycache;
+
+	remove(TRACE_FILE);
+	return failed_checks != 0;
+}
@@ -0,0 +1,114 @@
+#include "cache.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: the in-memory access API and the statistics it leaves */
+
+static void check(const char *what, const access_result_t &r, access_type_t type, unsigned latency){
+	cout << what << ": " << (r.type == HIT ? "hit" : "miss");
+	if (r.type != type){
+		cout << " (expected " << (type == HIT ? "hit" : "miss") << ")";
+		failed_checks++;
+	}
+	cout << ", ";
+	expect("latency", r.latency, latency);
+}
+
+int main(int argc, char **argv){
+
+	//four sets of two 64-byte ways, hit time 5, miss penalty 100
+	cache *mycache = new cache(512, 2, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+
+	check("read 0x0", mycache->access(0x0, 'r'), MISS, 105);
+	check("read 8 bytes at 0x8", mycache->access(0x8, 'r', 8), HIT, 5);
+	//hits line 0 and misses line 1: both lines count, and both become dirty
+	check("write 8 bytes at 0x3c", mycache->access(0x3c, 'w', 8), MISS, 110);
+
+	//0x1000 and 0x2000 share set 0 with 0x0, which is the least recently used and dirty
+	access_request_t requests[] = {{0x40, 'r', 4}, {0x1000, 'w', 4}, {0x2000, 'r', 4}};
+	access_result_t results[3];
+	expect("access_many hits", mycache->access_many(requests, 3, results), 1);
+	check("  read 0x40", results[0], HIT, 5);
+	check("  write 0x1000", results[1], MISS, 105);
+	check("  read 0x2000", results[2], MISS, 105);
+	expect("hits without results", mycache->access_many(requests, 1), 1);
+
+	//an access running past the top of the address space stops there
+	check("read 8 bytes at -4", mycache->access(-4, 'r', 8), MISS, 105);
+	//one crossing into the upper half splits at the line boundary as any other;
+	//its upper line lands in set 0 and evicts the dirty 0x1000
+	check("read 8 bytes at 2^63 - 4", mycache->access(0x7ffffffffffffffcLL, 'r', 8), MISS, 210);
+	//size 0 counts as a byte, missing in set 0 again and evicting the clean 0x2000
+	check("read 0 bytes at 0x0", mycache->access(0x0, 'r', 0), MISS, 105);
+
+	cache_stats_t s = mycache->statistics();
+	expect("reads", s.reads, 9);
+	expect("read misses", s.readMisses, 6);
+	expect("writes", s.writes, 3);
+	expect("write misses", s.writeMisses, 2);
+	expect("evictions", s.evictions, 3);
+	expect("memory writes", s.memoryWrites, 2);
+	cout << endl;
+	mycache->print_statistics();
+	cout << endl;
+	delete mycache;
+
+	//the same random accesses one at a time and in batches leave the same statistics
+	mycache = new cache(16*KB, 4, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	cache *batched = new cache(16*KB, 4, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	access_gen gen;
+	access_request_t batch[100];
+	unsigned long long latency = 0, batchLatency = 0, hits = 0, batchHits = 0;
+	for (unsigned i=0; i<400; i++){
+		for (unsigned j=0; j<100; j++){
+			gen.next();
+			batch[j].address = gen.offset(48*KB);
+			batch[j].op = gen.op();
+			batch[j].size = 1 + gen.bits(20) % 16;
+			access_result_t r = mycache->access(batch[j].address, batch[j].op, batch[j].size);
+			latency += r.latency;
+			if (r.type == HIT) hits++;
+		}
+		access_result_t r[100];
+		batchHits += batched->access_many(batch, 100, r);
+		for (unsigned j=0; j<100; j++) batchLatency += r[j].latency;
+	}
+	expect("batched hits", batchHits, hits);
+	expect("batched latency", batchLatency, latency);
+	s = mycache->statistics();
+	cache_stats_t b = batched->statistics();
+	expect("batched misses", b.readMisses + b.writeMisses, s.readMisses + s.writeMisses);
+	expect("batched evictions", b.evictions, s.evictions);
+	cout << "hits = " << hits << ", latency = " << latency << endl;
+	delete mycache;
+	delete batched;
+	cout << endl;
+
+	//two caches summed into one cache_stats_t: 0x0 missed then hit (average access time 55),
+	//and four cold reads (105); the sum weighs each cache's average time by its accesses
+	cache *warm = new cache(512, 2, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	cache *cold = new cache(512, 2, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	warm->access(0x0, 'r');
+	warm->access(0x0, 'r');
+	for (unsigned i=0; i<4; i++) cold->access(i * 64, 'r');
+	expect("warm average access time", (unsigned long long)warm->statistics().amat, 55);
+	cache_stats_t total = cache_stats_t();
+	warm->accumulate_statistics(total);
+	cold->accumulate_statistics(total);
+	expect("total accesses", total.accesses, 6);
+	expect("total reads", total.reads, 6);
+	expect("total read misses", total.readMisses, 5);
+	expect("total bytes filled", total.bytesFill, 5*64);
+	expect("total prefetches", total.prefetches, 0);
+	expect("total average access time x 3", (unsigned long long)(total.amat * 3 + 0.5), 265);
+	delete warm;
+	delete cold;
+
+	return failed_checks != 0;
+}
@@ -0,0 +1,76 @@
+#include "stack_distance.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: the LRU stack-distance profiler against simulated LRU caches */
+
+int main(int argc, char **argv){
+
+	//blocks A B C A B D A: four first touches, then A, B and A again each two distinct blocks back,
+	//so a 1- or 2-line cache misses all seven and a 3-line one only the first touches
+	stack_profiler small(64);
+	const char *blocks = "ABCABDA";
+	for (const char *b = blocks; *b; b++) small.access((*b - 'A') * 64);
+	expect("accesses", small.accesses(), 7);
+	expect("compulsory misses", small.compulsory_misses(), 4);
+	expect("misses with 2 lines", small.misses(2), 7);
+	expect("misses with 3 lines", small.misses(3), 4);
+	cout << endl;
+
+	//the same random accesses through the profiler and through real LRU caches
+	vector<unsigned> setCounts;
+	setCounts.push_back(12);	//not a power of two: left out
+	setCounts.push_back(16);
+	setCounts.push_back(64);
+	stack_profiler profiler(64, setCounts, 16);
+	vector<cache *> caches;
+	unsigned lines[] = {8, 64, 256};
+	for (unsigned i=0; i<3; i++){
+		//fully associative
+		caches.push_back(new cache(lines[i]*64, lines[i], 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32));
+	}
+	unsigned ways[] = {1, 4, 16};
+	for (unsigned s=1; s<3; s++){
+		for (unsigned w=0; w<3; w++){
+			caches.push_back(new cache(setCounts[s]*ways[w]*64, ways[w], 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32));
+		}
+	}
+	access_gen gen;
+	for (unsigned i=0; i<50000; i++){
+		gen.next();
+		address_t address = gen.offset((gen.bits(60) & 3) ? 16*KB : 256*KB);
+		profiler.access(address);
+		for (unsigned c=0; c<caches.size(); c++) caches[c]->access(address, gen.op());
+	}
+
+	for (unsigned i=0; i<3; i++){
+		cache_stats_t s = caches[i]->statistics();
+		cout << lines[i] << " lines, fully associative: ";
+		expect("misses", profiler.misses(lines[i]), s.readMisses + s.writeMisses);
+	}
+	for (unsigned s=1; s<3; s++){
+		for (unsigned w=0; w<3; w++){
+			cache_stats_t st = caches[3 + (s-1)*3 + w]->statistics();
+			cout << setCounts[s] << " sets, " << ways[w] << " ways: ";
+			expect("misses", profiler.misses(setCounts[s], ways[w]), st.readMisses + st.writeMisses);
+		}
+	}
+	expect("misses with 12 sets (not profiled)", profiler.misses(12, 4), profiler.accesses());
+	for (unsigned c=0; c<caches.size(); c++) delete caches[c];
+	cout << endl;
+
+	profiler.print_miss_ratio_curve();
+	cout << endl;
+
+	//an empty profile has no misses to report
+	stack_profiler empty(64, setCounts, 4);
+	empty.print_miss_ratio_curve();
+
+	return failed_checks != 0;
+}
@@ -0,0 +1,195 @@
+#include "cache.h"
+#include "access_gen.h"
+#include "le_bytes.h"
+#include <iostream>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: text and binary traces, and the converter between them */
+
+#define TEXT_FILE "testcase19.t"
+#define BINARY_FILE "testcase19.bin"
+#define DAMAGED_FILE "testcase19.bad"
+
+static void write_file(const char *filename, const unsigned char *bytes, size_t size){
+	FILE *f = fopen(filename, "wb");
+	fwrite(bytes, 1, size, f);
+	fclose(f);
+}
+
+//reads a whole file into "bytes"
+static void read_file(const char *filename, vector<unsigned char> &bytes){
+	bytes.clear();
+	FILE *f = fopen(filename, "rb");
+	int c;
+	while ((c = fgetc(f)) != EOF) bytes.push_back((unsigned char)c);
+	fclose(f);
+}
+
+static void try_open(const char *what, trace_format_t format){
+	trace_reader trace;
+	bool ok = trace.open(DAMAGED_FILE, format);
+	cout << what << ": open = " << ok;
+	if (!ok) cout << " (" << trace.error() << ")";
+	cout << endl;
+}
+
+int main(int argc, char **argv){
+
+	//text entries with CRLF line ends, blank lines, upper-case digits, no "0x", extra fields
+	//and no newline at the end of the file
+	FILE *f = fopen(TEXT_FILE, "wb");
+	fputs("r 0x1F\r\n\r\n  w\t40 0x4005d2 0x3\nr 0XABC 0x10\nw 7", f);
+	fclose(f);
+	trace_reader trace;
+	char op;
+	long long address, pc, tag;
+	trace.open(TEXT_FILE);
+	const char *textOps = "rwrw";
+	long long textAddresses[] = {0x1f, 0x40, 0xabc, 0x7}, pcs[] = {0, 0x4005d2, 0x10, 0}, tags[] = {0, 0x3, 0, 0};
+	unsigned n = 0;
+	while (trace.next(op, address, pc, tag)){
+		if (n < 4){
+			expect("op matches", op == textOps[n], 1);
+			expect("address matches", address == textAddresses[n], 1);
+			expect("pc matches", pc == pcs[n], 1);
+			expect("tag matches", tag == tags[n], 1);
+		}
+		n++;
+	}
+	expect("entries read", n, 4);
+
+	//a multi-core trace, and a second reader sharing the first one's mapping
+	f = fopen(TEXT_FILE, "w");
+	fputs("0 r 0x100\n12 w 0x200\n3 r 0x300\n", f);
+	fclose(f);
+	trace.open(TEXT_FILE);
+	trace_reader shared;
+	shared.share(trace);
+	unsigned core, cores[] = {0, 12, 3};
+	n = 0;
+	while (trace.next(core, op, address)){
+		if (n < 3) expect("core matches", core == cores[n], 1);
+		n++;
+	}
+	expect("entries read", n, 3);
+	expect("shared reader starts over", shared.next(core, op, address) && core == 0 && address == 0x100, 1);
+	cout << endl;
+
+	//three one-byte entries: the deltas 0x10, -8 and -9 zigzag to 0x20, 15 and 17, which fit in
+	//the six address bits of the first byte
+	f = fopen(TEXT_FILE, "w");
+	fputs("r 0x10\nw 0x8\ni 0x400\nr 0xffffffffffffffff\n", f);
+	fclose(f);
+	unsigned long long dropped = 0;
+	expect("entries converted", convert_trace(TEXT_FILE, BINARY_FILE, &dropped), 3);
+	expect("entries dropped", dropped, 1);
+	vector<unsigned char> bytes;
+	read_file(BINARY_FILE, bytes);
+	expect("file size", bytes.size(), TRACE_HEADER_SIZE + 3);
+	expect("header entry count", get_le(&bytes[8], 8), 3);
+	expect("header length", get_le(&bytes[16], 8), 3);
+	trace.open(BINARY_FILE);
+	const char *ops = "rwr";
+	long long addresses[] = {0x10, 0x8, -1};
+	n = 0;
+	while (trace.next(op, address)){
+		if (n < 3){
+			expect("op matches", op == ops[n], 1);
+			expect("address matches", address == addresses[n], 1);
+		}
+		n++;
+	}
+	expect("entries read", n, 3);
+	cout << endl;
+
+	//random reads and writes, with 64-bit addresses, large jumps and instruction fetches mixed in
+	f = fopen(TEXT_FILE, "w");
+	access_gen gen;
+	unsigned long long fetches = 0;
+	for (unsigned i=0; i<20000; i++){
+		gen.next();
+		switch (gen.bits(58) & 7){
+			case 0: fprintf(f, "i 0x%llx\n", (unsigned long long)gen.offset(1024*KB)); fetches++; break;
+			case 1: fprintf(f, "%c 0x%llx\n", gen.op(), gen.bits(1)); break;
+			default: fprintf(f, "%c 0x%llx\n", gen.op(), (unsigned long long)gen.offset(64*KB)); break;
+		}
+	}
+	fclose(f);
+	long long entries = convert_trace(TEXT_FILE, BINARY_FILE, &dropped);
+	expect("entries converted", entries, 20000 - fetches);
+	expect("entries dropped", dropped, fetches);
+
+	trace_reader text, binary;
+	expect("text opens as binary", binary.open(TEXT_FILE, TRACE_BINARY), 0);
+	expect("binary opens as text", text.open(BINARY_FILE, TRACE_TEXT), 0);
+	text.open(TEXT_FILE);
+	binary.open(BINARY_FILE);
+	char binaryOp;
+	long long binaryAddress;
+	unsigned mismatches = 0;
+	n = 0;
+	while (text.next(op, address)){
+		if (op != 'r' && op != 'w') continue;
+		if (!binary.next(binaryOp, binaryAddress) || binaryOp != op || binaryAddress != address) mismatches++;
+		n++;
+	}
+	expect("entries compared", n, entries);
+	expect("mismatches", mismatches, 0);
+	expect("entries left in the binary trace", binary.next(binaryOp, binaryAddress), 0);
+
+	//both formats drive a cache to the same statistics
+	cache *fromText = new cache(16*KB, 4, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	cache *fromBinary = new cache(16*KB, 4, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	fromText->load_trace(TEXT_FILE);
+	fromBinary->load_trace(BINARY_FILE);
+	fromText->run();
+	fromBinary->run();
+	cache_stats_t t = fromText->statistics(), b = fromBinary->statistics();
+	expect("read misses match", b.readMisses, t.readMisses);
+	expect("write misses match", b.writeMisses, t.writeMisses);
+	expect("evictions match", b.evictions, t.evictions);
+	cout << "read misses = " << b.readMisses << ", write misses = " << b.writeMisses << endl;
+	//a run stopped and resumed picks the trace up where it left off
+	cache *resumed = new cache(16*KB, 4, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	resumed->load_trace(TEXT_FILE);
+	resumed->run(5000);
+	resumed->run(1);
+	resumed->run();
+	expect("resumed read misses match", resumed->statistics().readMisses, t.readMisses);
+	expect("resumed accesses match", resumed->statistics().accesses, t.accesses);
+	delete resumed;
+	delete fromText;
+	delete fromBinary;
+	cout << endl;
+
+	//damaged binary traces: a file shorter than its header says is caught on open, without reading it;
+	//a last entry whose final byte lost its end mark is only found by reading up to it
+	read_file(BINARY_FILE, bytes);
+	write_file(DAMAGED_FILE, &bytes[0], bytes.size() - 3);
+	try_open("truncated", TRACE_AUTO);
+	vector<unsigned char> damaged(bytes);
+	damaged.back() |= 0x80;
+	write_file(DAMAGED_FILE, &damaged[0], damaged.size());
+	try_open("unterminated last entry", TRACE_AUTO);
+	trace.open(DAMAGED_FILE);
+	n = 0;
+	while (trace.next(op, address)) n++;
+	expect("entries read", n, entries - 1);
+	cout << "error = " << (trace.error() ? trace.error() : "none") << endl;
+	damaged = bytes;
+	put_le(&damaged[4], 1, 4);
+	write_file(DAMAGED_FILE, &damaged[0], damaged.size());
+	try_open("version 1", TRACE_AUTO);
+	try_open("version 1", TRACE_BINARY);
+
+	remove(TEXT_FILE);
+	remove(BINARY_FILE);
+	remove(DAMAGED_FILE);
+	return failed_checks != 0;
+}
@@ -0,0 +1,110 @@
+#include "cache.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: victim cache and miss cache */
+
+//two direct-mapped 64-byte lines (hit time 5, miss penalty 100), so blocks 0x0, 0x80, 0x100
+//and 0x180 all fight over set 0
+static cache *make_cache(unsigned entries, assist_cache_t kind){
+	cache *c = new cache(128, 1, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	if (entries) c->set_victim_cache(entries, kind);
+	return c;
+}
+
+//fixed pseudo-random accesses over "footprint" bytes
+static void run_accesses(cache *c, unsigned count, unsigned footprint){
+	access_gen gen;
+	for (unsigned i=0; i<count; i++){
+		gen.next();
+		c->access(gen.offset(footprint), gen.op());
+	}
+}
+
+int main(int argc, char **argv){
+
+	//a one-entry victim cache:
+	//  r 0x0     miss
+	//  r 0x80    miss, 0x0 goes to the victim cache
+	//  r 0x0     victim hit, swapped with 0x80
+	//  r 0x80    victim hit, swapped with 0x0
+	//  w 0x100   miss, 0x80 goes in and displaces the clean 0x0
+	//  r 0x0     miss, the dirty 0x100 goes in and displaces the clean 0x80
+	//  r 0x180   miss, 0x0 goes in and displaces the dirty 0x100, which is written back
+	cache *mycache = make_cache(1, VICTIM_CACHE);
+	mycache->access(0x0, 'r');
+	mycache->access(0x80, 'r');
+	mycache->access(0x0, 'r');
+	mycache->access(0x80, 'r');
+	mycache->access(0x100, 'w');
+	mycache->access(0x0, 'r');
+	mycache->access(0x180, 'r');
+	cache_stats_t s = mycache->statistics();
+	expect("read misses", s.readMisses, 4);
+	expect("write misses", s.writeMisses, 1);
+	expect("victim cache hits", s.assistHits, 2);
+	expect("evictions", s.evictions, 6);	//every replacement but the first fill of set 0
+	expect("memory writes", s.memoryWrites, 1);
+	expect("bytes written back", s.bytesWriteback, 64);
+	delete mycache;
+
+	//a two-entry miss cache keeps clean copies of the last two missed blocks:
+	//  r 0x0     miss, copied
+	//  r 0x80    miss, copied
+	//  r 0x0     miss cache hit
+	//  r 0x80    miss cache hit
+	//  r 0x100   miss, its copy displaces 0x0, the least recently used
+	//  r 0x0     miss
+	mycache = make_cache(2, MISS_CACHE);
+	mycache->access(0x0, 'r');
+	mycache->access(0x80, 'r');
+	mycache->access(0x0, 'r');
+	mycache->access(0x80, 'r');
+	mycache->access(0x100, 'r');
+	mycache->access(0x0, 'r');
+	s = mycache->statistics();
+	expect("read misses", s.readMisses, 4);
+	expect("miss cache hits", s.assistHits, 2);
+	delete mycache;
+
+	//a dirty line swapped back from the victim cache stays dirty, and is written back when it leaves
+	mycache = make_cache(1, VICTIM_CACHE);
+	mycache->access(0x0, 'w');
+	mycache->access(0x80, 'r');
+	mycache->access(0x0, 'r');
+	mycache->access(0x100, 'r');
+	mycache->access(0x180, 'r');
+	s = mycache->statistics();
+	expect("victim cache hits", s.assistHits, 1);
+	expect("memory writes", s.memoryWrites, 1);
+	cout << endl;
+	delete mycache;
+
+	const char *names[] = {"NO ASSIST CACHE", "VICTIM CACHE", "MISS CACHE"};
+	unsigned entries[] = {0, 4, 4};
+	assist_cache_t kinds[] = {VICTIM_CACHE, VICTIM_CACHE, MISS_CACHE};
+
+	for (unsigned t=0; t<3; t++){
+
+		cout << names[t] << endl;
+		cout << "===================" << endl << endl;
+
+		mycache = new cache(4*KB, 1, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+		if (entries[t]) mycache->set_victim_cache(entries[t], kinds[t]);
+
+		mycache->print_configuration();
+		run_accesses(mycache, 40000, 8*KB);
+		cout << endl;
+		mycache->print_statistics();
+		cout << endl;
+
+		delete mycache;
+	}
+	return failed_checks != 0;
+}
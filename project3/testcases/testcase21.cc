@@ -0,0 +1,115 @@
+#include "sweep.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: a design-space sweep, serial and on worker threads, against the
+   same caches run one by one */
+
+#define TRACE "testcase21.t"
+
+//writes "count" fixed pseudo-random entries over "footprint" bytes as a text trace
+static void write_trace(unsigned count, unsigned footprint){
+	FILE *f = fopen(TRACE, "w");
+	access_gen gen;
+	for (unsigned i=0; i<count; i++){
+		gen.next();
+		fprintf(f, "%c 0x%llx\n", gen.op(), gen.offset(footprint));
+	}
+	fclose(f);
+}
+
+static bool same_stats(const cache_stats_t &a, const cache_stats_t &b){
+	return a.accesses == b.accesses && a.reads == b.reads && a.readMisses == b.readMisses &&
+	       a.writes == b.writes && a.writeMisses == b.writeMisses && a.evictions == b.evictions &&
+	       a.memoryWrites == b.memoryWrites && a.bytesFill == b.bytesFill &&
+	       a.bytesWriteback == b.bytesWriteback && a.bytesWriteThrough == b.bytesWriteThrough &&
+	       a.amat == b.amat;
+}
+
+//statistics of "config" run alone over the trace
+static cache_stats_t run_alone(const cache_config_t &config){
+	cache *c = new cache(config.size, config.associativity, config.line_size, config.write_hit_policy,
+	                     config.write_miss_policy, 2, 100, 32, config.replacement);
+	c->load_trace(TRACE);
+	c->run();
+	cache_stats_t s = c->statistics();
+	delete c;
+	return s;
+}
+
+int main(int argc, char **argv){
+
+	//r 0x0, r 0x80, r 0x0, w 0x100, r 0x0 through four write-back, write-allocate caches:
+	//  128 B direct-mapped, 64 B lines    every access conflicts in set 0       4 read misses
+	//  128 B 2-way, 64 B lines            0x100 replaces 0x80, 0x0 stays        2 read misses
+	//  256 B direct-mapped, 64 B lines    0x80 gets set 2, 0x100 evicts 0x0     3 read misses
+	//  256 B direct-mapped, 128 B lines   0x80 gets set 1, 0x100 evicts 0x0     3 read misses
+	//and the write always misses
+	FILE *f = fopen(TRACE, "w");
+	fputs("r 0x0\nr 0x80\nr 0x0\nw 0x100\nr 0x0\n", f);
+	fclose(f);
+	cache_config_t small[] = {{128, 1, 64, WRITE_BACK, WRITE_ALLOCATE},
+	                          {128, 2, 64, WRITE_BACK, WRITE_ALLOCATE},
+	                          {256, 1, 64, WRITE_BACK, WRITE_ALLOCATE},
+	                          {256, 1, 128, WRITE_BACK, WRITE_ALLOCATE}};
+	unsigned readMisses[] = {4, 2, 3, 3};
+	cache_sweep *sweep = new cache_sweep(vector<cache_config_t>(small, small + 4), 2, 100, 32);
+	expect("run", sweep->run(TRACE), 1);
+	vector<sweep_result_t> results = sweep->results();
+	for (unsigned i=0; i<4; i++){
+		expect("read misses", results[i].stats.readMisses, readMisses[i]);
+		expect("  write misses", results[i].stats.writeMisses, 1);
+	}
+	delete sweep;
+	cout << endl;
+
+	//every size, associativity, line size, write policy and replacement policy mixed together,
+	//so caches of one line size share a group
+	vector<cache_config_t> configs;
+	unsigned sizes[] = {4*KB, 16*KB};
+	unsigned ways[] = {1, 4};
+	unsigned lines[] = {32, 64};
+	replacement_policy_t policies[] = {REPLACE_LRU, REPLACE_SRRIP};
+	for (unsigned s=0; s<2; s++)
+		for (unsigned w=0; w<2; w++)
+			for (unsigned l=0; l<2; l++){
+				cache_config_t c = {sizes[s], ways[w], lines[l], (l ? WRITE_THROUGH : WRITE_BACK),
+				                    (l ? NO_WRITE_ALLOCATE : WRITE_ALLOCATE), policies[(s + w) % 2]};
+				configs.push_back(c);
+			}
+	write_trace(50000, 64*KB);
+
+	sweep = new cache_sweep(configs, 2, 100, 32);
+	expect("run", sweep->run(TRACE), 1);
+	results = sweep->results();
+	unsigned matching = 0;
+	for (unsigned i=0; i<configs.size(); i++) matching += same_stats(results[i].stats, run_alone(configs[i]));
+	expect("configurations matching a cache run alone", matching, configs.size());
+
+	//the threads split the caches between them, so any number of them (more than there are
+	//caches included) gives the serial results
+	unsigned threads[] = {1, 2, 3, 16};
+	for (unsigned t=0; t<4; t++){
+		cout << threads[t] << " threads" << endl;
+		cache_sweep *parallel = new cache_sweep(configs, 2, 100, 32);
+		expect("  run_parallel", parallel->run_parallel(TRACE, threads[t]), 1);
+		vector<sweep_result_t> shared = parallel->results();
+		matching = 0;
+		for (unsigned i=0; i<configs.size(); i++) matching += same_stats(shared[i].stats, results[i].stats);
+		expect("  configurations matching run", matching, configs.size());
+		delete parallel;
+	}
+	cout << endl;
+	sweep->print_results();
+	delete sweep;
+
+	remove(TRACE);
+	return failed_checks != 0;
+}
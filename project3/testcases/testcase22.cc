@@ -0,0 +1,100 @@
+#include "cache.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: set-sharded runs against the serial run */
+
+#define TRACE "testcase22.t"
+
+//writes "count" fixed pseudo-random entries over "footprint" bytes as a text trace
+static void write_trace(unsigned count, unsigned footprint){
+	FILE *f = fopen(TRACE, "w");
+	access_gen gen;
+	for (unsigned i=0; i<count; i++){
+		gen.next();
+		fprintf(f, "%c 0x%llx\n", gen.op(), gen.offset(footprint));
+	}
+	fclose(f);
+}
+
+static cache *make_cache(unsigned size, unsigned ways, write_policy_t hit, write_policy_t miss,
+                         replacement_policy_t policy=REPLACE_LRU){
+	cache *c = new cache(size, ways, 64, hit, miss, 2, 100, 32, policy);
+	c->load_trace(TRACE);
+	return c;
+}
+
+//the statistics and tag array a cache prints
+static string dump(cache *c){
+	stringstream out;
+	streambuf *old = cout.rdbuf(out.rdbuf());
+	c->print_statistics();
+	c->print_tag_array();
+	cout.rdbuf(old);
+	return out.str();
+}
+
+int main(int argc, char **argv){
+
+	//r 0x0, r 0x80, r 0x0, w 0x100, r 0x0 through a 256 B direct-mapped cache of 64 B lines on two
+	//threads: 0x80 gets set 2, 0x100 evicts 0x0 from set 0 and is evicted by it again, so reads miss
+	//3 times and the write once;
+	//two entries first and the rest after give the same counts
+	FILE *f = fopen(TRACE, "w");
+	fputs("r 0x0\nr 0x80\nr 0x0\nw 0x100\nr 0x0\n", f);
+	fclose(f);
+	cache *mycache = make_cache(256, 1, WRITE_BACK, WRITE_ALLOCATE);
+	mycache->run_sharded(2, 2);
+	mycache->run_sharded(0, 2);
+	cache_stats_t s = mycache->statistics();
+	expect("accesses", s.accesses, 5);
+	expect("read misses", s.readMisses, 3);
+	expect("write misses", s.writeMisses, 1);
+	expect("evictions", s.evictions, 2);
+	delete mycache;
+	cout << endl;
+
+	//LRU caches are split over the threads, SRRIP falls back to run; either way every thread count
+	//prints what run prints
+	write_trace(50000, 64*KB);
+	const char *names[] = {"16 KB 4-WAY WB/WA", "16 KB 4-WAY WT/NWA", "4 KB DIRECT-MAPPED WB/WA", "16 KB 4-WAY SRRIP"};
+	unsigned sizes[] = {16*KB, 16*KB, 4*KB, 16*KB};
+	unsigned ways[] = {4, 4, 1, 4};
+	write_policy_t hit[] = {WRITE_BACK, WRITE_THROUGH, WRITE_BACK, WRITE_BACK};
+	write_policy_t miss[] = {WRITE_ALLOCATE, NO_WRITE_ALLOCATE, WRITE_ALLOCATE, WRITE_ALLOCATE};
+	replacement_policy_t policies[] = {REPLACE_LRU, REPLACE_LRU, REPLACE_LRU, REPLACE_SRRIP};
+	unsigned threads[] = {1, 2, 3, 8};
+
+	for (unsigned t=0; t<4; t++){
+		cout << names[t] << endl;
+		mycache = make_cache(sizes[t], ways[t], hit[t], miss[t], policies[t]);
+		mycache->run();
+		string serial = dump(mycache);
+		delete mycache;
+
+		for (unsigned n=0; n<4; n++){
+			mycache = make_cache(sizes[t], ways[t], hit[t], miss[t], policies[t]);
+			mycache->run_sharded(20000, threads[n]);
+			mycache->run_sharded(0, threads[n]);
+			cout << "  " << threads[n] << " threads: ";
+			expect("same statistics and tag array as run", dump(mycache) == serial, 1);
+			delete mycache;
+		}
+	}
+	cout << endl;
+
+	mycache = make_cache(16*KB, 4, WRITE_BACK, WRITE_ALLOCATE);
+	mycache->run_sharded(0, 4);
+	mycache->print_statistics();
+	delete mycache;
+
+	remove(TRACE);
+	return failed_checks != 0;
+}
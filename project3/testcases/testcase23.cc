@@ -0,0 +1,107 @@
+#include "cache.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: the specialized replay kernels against the general access path */
+
+#define TRACE "testcase23.t"
+
+//writes "count" fixed pseudo-random word-aligned entries over "footprint" bytes as a text trace,
+//so that access() of a WRITE_BYTES word touches one line just as the trace entry does
+static void write_trace(unsigned count, unsigned footprint){
+	FILE *f = fopen(TRACE, "w");
+	access_gen gen;
+	for (unsigned i=0; i<count; i++){
+		gen.next();
+		fprintf(f, "%c 0x%llx\n", gen.op(), gen.offset(footprint) & ~(unsigned long long)(WRITE_BYTES - 1));
+	}
+	fclose(f);
+}
+
+//the statistics and tag array a cache prints
+static string dump(cache *c){
+	stringstream out;
+	streambuf *old = cout.rdbuf(out.rdbuf());
+	c->print_statistics();
+	c->print_tag_array();
+	cout.rdbuf(old);
+	return out.str();
+}
+
+//the whole trace through the kernel (run on a plain LRU cache) or through access() one entry at a time
+static string replay(unsigned size, unsigned ways, write_policy_t hit, write_policy_t miss, bool kernel){
+	cache *c = new cache(size, ways, 64, hit, miss, 2, 100, 32);
+	if (kernel){
+		c->load_trace(TRACE);
+		c->run();
+	}
+	else{
+		trace_reader trace;
+		trace.open(TRACE);
+		char op;
+		long long address;
+		while (trace.next(op, address)) c->access(address, op, WRITE_BYTES);
+	}
+	string printed = dump(c);
+	delete c;
+	return printed;
+}
+
+int main(int argc, char **argv){
+
+	//w 0x0, r 0x0, w 0x0, r 0x40, r 0x80, r 0x0 through one set of two 64-byte lines:
+	//  WB/WA    the write allocates 0x0 dirty and the next two accesses hit; 0x80 evicts the dirty 0x0
+	//           (used before 0x40), which is written back, and 0x0 then evicts 0x40
+	//  WT/NWA   the write miss goes to memory without a fill, so all four reads miss, and the write hit
+	//           goes through; 0x80 evicts 0x0 and 0x0 then evicts 0x40
+	FILE *f = fopen(TRACE, "w");
+	fputs("w 0x0\nr 0x0\nw 0x0\nr 0x40\nr 0x80\nr 0x0\n", f);
+	fclose(f);
+	write_policy_t hit[] = {WRITE_BACK, WRITE_THROUGH, WRITE_BACK, WRITE_THROUGH};
+	write_policy_t miss[] = {WRITE_ALLOCATE, NO_WRITE_ALLOCATE, NO_WRITE_ALLOCATE, WRITE_ALLOCATE};
+	unsigned readMisses[] = {3, 4}, writeMisses[] = {1, 1}, evictions[] = {2, 2}, memoryWrites[] = {1, 2};
+	unsigned long long bytesWriteback[] = {64, 0}, bytesWriteThrough[] = {0, 2*WRITE_BYTES};
+	for (unsigned p=0; p<2; p++){
+		cache *mycache = new cache(128, 2, 64, hit[p], miss[p], 2, 100, 32);
+		mycache->load_trace(TRACE);
+		mycache->run();
+		cache_stats_t s = mycache->statistics();
+		cout << (p ? "WT/NWA" : "WB/WA") << endl;
+		expect("  read misses", s.readMisses, readMisses[p]);
+		expect("  write misses", s.writeMisses, writeMisses[p]);
+		expect("  evictions", s.evictions, evictions[p]);
+		expect("  memory writes", s.memoryWrites, memoryWrites[p]);
+		expect("  bytes written back", s.bytesWriteback, bytesWriteback[p]);
+		expect("  bytes written through", s.bytesWriteThrough, bytesWriteThrough[p]);
+		delete mycache;
+	}
+	cout << endl;
+
+	//every specialized associativity and the run-time fallback (3 ways), with all four write policy pairs
+	write_trace(50000, 64*KB);
+	unsigned ways[] = {1, 2, 4, 8, 16, 3};
+	for (unsigned w=0; w<6; w++){
+		for (unsigned p=0; p<4; p++){
+			cout << dec << ways[w] << "-way " << (hit[p] == WRITE_BACK ? "WB" : "WT") << "/" << (miss[p] == WRITE_ALLOCATE ? "WA" : "NWA") << ": ";
+			unsigned size = 64 * 64 * ways[w];	//64 sets
+			expect("kernel matches access()", replay(size, ways[w], hit[p], miss[p], true) == replay(size, ways[w], hit[p], miss[p], false), 1);
+		}
+	}
+	cout << endl;
+
+	cache *mycache = new cache(16*KB, 4, 64, WRITE_BACK, WRITE_ALLOCATE, 2, 100, 32);
+	mycache->load_trace(TRACE);
+	mycache->run();
+	mycache->print_statistics();
+	delete mycache;
+
+	remove(TRACE);
+	return failed_checks != 0;
+}
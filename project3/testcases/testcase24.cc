@@ -0,0 +1,94 @@
+#include "cache.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: non-blocking timing with MSHRs */
+
+//fixed pseudo-random accesses over "footprint" bytes
+static void run_accesses(cache *c, unsigned count, unsigned footprint){
+	access_gen gen;
+	for (unsigned i=0; i<count; i++){
+		gen.next();
+		c->access(gen.offset(footprint), gen.op());
+	}
+}
+
+//the value print_statistics gives for "label"
+static double printed(cache *c, const string &label){
+	stringstream out;
+	streambuf *old = cout.rdbuf(out.rdbuf());
+	c->print_statistics();
+	cout.rdbuf(old);
+	string line;
+	while (getline(out, line)){
+		if (line.compare(0, label.size() + 3, label + " = ") == 0) return atof(line.c_str() + label.size() + 3);
+	}
+	return -1;
+}
+
+int main(int argc, char **argv){
+
+	//two MSHRs, one access issued per cycle, hit time 2 and miss penalty 100:
+	//  cycle 0     r 0x0     primary miss, ready at 102
+	//  cycle 1     r 0x8     same block, merged into its MSHR, done at 102
+	//  cycle 2     r 0x40    primary miss, ready at 104; both MSHRs are busy now
+	//  cycle 3     r 0x80    stalls 99 cycles for the MSHR of 0x0, issues at 102, ready at 204
+	//  cycle 103   r 0x0     hit, done at 105
+	//the misses take 3 x 102 cycles over the 204 cycles with one outstanding, and the accesses
+	//102 + 101 + 102 + 201 + 2 = 508 cycles
+	cache *mycache = new cache(16*KB, 4, 64, WRITE_BACK, WRITE_ALLOCATE, 2, 100, 32);
+	mycache->set_mshrs(2);
+	mycache->access(0x0, 'r');
+	mycache->access(0x8, 'r');
+	mycache->access(0x40, 'r');
+	mycache->access(0x80, 'r');
+	mycache->access(0x0, 'r');
+	expect("primary misses", printed(mycache, "primary misses"), 3);
+	expect("secondary misses merged", printed(mycache, "secondary misses merged"), 1);
+	expect("MSHR full stalls", printed(mycache, "MSHR full stalls"), 1);
+	expect("execution cycles", printed(mycache, "execution cycles"), 204);
+	expect("memory-level parallelism x 10", printed(mycache, "memory-level parallelism") * 10, 15);
+	expect("average access latency x 10", printed(mycache, "average access latency") * 10 + 0.5, 1016);
+	delete mycache;
+
+	//issuing every 200 cycles leaves nothing in flight, so nothing merges or stalls and the
+	//last access, a miss issued at cycle 800, completes at 902
+	mycache = new cache(16*KB, 4, 64, WRITE_BACK, WRITE_ALLOCATE, 2, 100, 32);
+	mycache->set_mshrs(2, 200);
+	mycache->access(0x0, 'r');
+	mycache->access(0x8, 'r');
+	mycache->access(0x40, 'r');
+	mycache->access(0x80, 'r');
+	mycache->access(0xc0, 'r');
+	expect("secondary misses merged", printed(mycache, "secondary misses merged"), 0);
+	expect("MSHR full stalls", printed(mycache, "MSHR full stalls"), 0);
+	expect("execution cycles", printed(mycache, "execution cycles"), 902);
+	cout << endl;
+	delete mycache;
+
+	unsigned entries[] = {1, 4, 16};
+
+	for (unsigned m=0; m<3; m++){
+
+		cout << entries[m] << " MSHRS" << endl;
+		cout << "===================" << endl << endl;
+
+		mycache = new cache(16*KB, 4, 64, WRITE_BACK, WRITE_ALLOCATE, 2, 100, 32);
+		mycache->set_mshrs(entries[m]);
+
+		mycache->print_configuration();
+		run_accesses(mycache, 40000, 64*KB);
+		cout << endl;
+		mycache->print_statistics();
+		cout << endl;
+
+		delete mycache;
+	}
+	return failed_checks != 0;
+}
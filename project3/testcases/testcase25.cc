@@ -0,0 +1,118 @@
+#include "cache.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: misses, evictions and writebacks profiled per PC, page and tag */
+
+#define TRACE "testcase25.t"
+
+//one row of a profile table: key, accesses, misses, evictions, writebacks
+typedef struct{
+	long long key;
+	unsigned long long accesses, misses, evictions, writebacks;
+} row_t;
+
+//the rows of the table titled "title" in what print_statistics prints
+static vector<row_t> table(cache *c, const string &title){
+	stringstream out;
+	streambuf *old = cout.rdbuf(out.rdbuf());
+	c->print_statistics();
+	cout.rdbuf(old);
+	vector<row_t> rows;
+	string line;
+	while (getline(out, line) && line != title);
+	getline(out, line);	//column names
+	while (getline(out, line) && !line.empty()){
+		stringstream fields(line);
+		string key;
+		double rate;
+		row_t r;
+		fields >> key >> r.accesses >> r.misses >> rate >> r.evictions >> r.writebacks;
+		r.key = strtoll(key.c_str(), NULL, 16);
+		rows.push_back(r);
+	}
+	return rows;
+}
+
+static void check_table(cache *c, const string &title, const row_t *expected, unsigned n){
+	vector<row_t> rows = table(c, title);
+	cout << title << endl;
+	expect("  rows", rows.size(), n);
+	for (unsigned i=0; i<n && i<rows.size(); i++){
+		cout << "  0x" << hex << rows[i].key << dec << endl;
+		expect("    key matches", rows[i].key == expected[i].key, 1);
+		expect("    accesses", rows[i].accesses, expected[i].accesses);
+		expect("    misses", rows[i].misses, expected[i].misses);
+		expect("    evictions", rows[i].evictions, expected[i].evictions);
+		expect("    writebacks", rows[i].writebacks, expected[i].writebacks);
+	}
+}
+
+int main(int argc, char **argv){
+
+	//two direct-mapped 64-byte lines, write-back and write-allocate:
+	//  r 0x0      pc 0x400  tag 1   miss in set 0
+	//  w 0x0      pc 0x404  tag 1   hit, the line turns dirty
+	//  r 0x80     pc 0x408  tag 2   miss, evicts the dirty 0x0, written back
+	//  r 0x1000   pc 0x408  tag 2   miss, evicts 0x80
+	//  r 0x1040   pc 0x40c  tag 1   miss in set 1
+	//  r 0x1000   pc 0x400  tag 1   hit
+	//evictions go to the evicting PC and tag and to the victim's page; the top three PCs are
+	//0x408, then 0x400 and 0x40c, tied on misses and evictions, in key order
+	FILE *f = fopen(TRACE, "w");
+	fputs("r 0x0 0x400 0x1\nw 0x0 0x404 0x1\nr 0x80 0x408 0x2\nr 0x1000 0x408 0x2\n"
+	      "r 0x1040 0x40c 0x1\nr 0x1000 0x400 0x1\n", f);
+	fclose(f);
+	cache *mycache = new cache(128, 1, 64, WRITE_BACK, WRITE_ALLOCATE, 2, 100, 32);
+	mycache->set_miss_profile(3);
+	mycache->load_trace(TRACE);
+	mycache->run();
+	row_t pcs[] = {{0x408, 2, 2, 2, 1}, {0x400, 2, 1, 0, 0}, {0x40c, 1, 1, 0, 0}};
+	row_t pages[] = {{0x0, 3, 2, 2, 1}, {0x1, 3, 2, 0, 0}};
+	row_t tags[] = {{0x2, 2, 2, 2, 1}, {0x1, 4, 2, 0, 0}};
+	check_table(mycache, "TOP MISS PCS", pcs, 3);
+	check_table(mycache, "TOP MISS PAGES", pages, 2);
+	check_table(mycache, "TOP MISS TAGS", tags, 2);
+	delete mycache;
+
+	//without PC and tag fields only the page table is printed
+	f = fopen(TRACE, "w");
+	fputs("r 0x0\nr 0x80\n", f);
+	fclose(f);
+	mycache = new cache(128, 1, 64, WRITE_BACK, WRITE_ALLOCATE, 2, 100, 32);
+	mycache->set_miss_profile(3);
+	mycache->load_trace(TRACE);
+	mycache->run();
+	expect("PC rows without PCs", table(mycache, "TOP MISS PCS").size(), 0);
+	expect("page rows", table(mycache, "TOP MISS PAGES").size(), 1);
+	cout << endl;
+	delete mycache;
+
+	//fixed pseudo-random accesses from eight PCs, each over its own 16 KB array tagged with the PC's number
+	f = fopen(TRACE, "w");
+	access_gen gen;
+	for (unsigned i=0; i<40000; i++){
+		gen.next();
+		unsigned pc = gen.bits(20) & 7;
+		fprintf(f, "%c 0x%llx 0x%x 0x%x\n", gen.op(), 0x100000ULL * (pc + 1) + gen.offset(16*KB >> (pc & 3)), 0x400000 + 4 * pc, pc + 1);
+	}
+	fclose(f);
+	mycache = new cache(16*KB, 4, 64, WRITE_BACK, WRITE_ALLOCATE, 2, 100, 32);
+	mycache->set_miss_profile(5);
+	mycache->load_trace(TRACE);
+	mycache->print_configuration();
+	mycache->run();
+	cout << endl;
+	mycache->print_statistics();
+	delete mycache;
+
+	remove(TRACE);
+	return failed_checks != 0;
+}
@@ -0,0 +1,87 @@
+#include "cache.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: the AVX2 replay kernels against the scalar ones */
+
+#define TRACE "testcase26.t"
+
+//writes "count" fixed pseudo-random entries over "footprint" bytes as a text trace
+static void write_trace(unsigned count, unsigned footprint){
+	FILE *f = fopen(TRACE, "w");
+	access_gen gen;
+	for (unsigned i=0; i<count; i++){
+		gen.next();
+		fprintf(f, "%c 0x%llx\n", gen.op(), gen.offset(footprint));
+	}
+	fclose(f);
+}
+
+//the statistics and tag array a cache prints
+static string dump(cache *c){
+	stringstream out;
+	streambuf *old = cout.rdbuf(out.rdbuf());
+	c->print_statistics();
+	c->print_tag_array();
+	cout.rdbuf(old);
+	return out.str();
+}
+
+//the whole trace through the kernels, with the AVX2 ones allowed or not, serially or on three threads
+static string replay(unsigned ways, write_policy_t hit, write_policy_t miss, bool simd, bool sharded){
+	cache *c = new cache(64 * 64 * ways, ways, 64, hit, miss, 2, 100, 32);	//64 sets
+	c->set_simd_kernels(simd);
+	c->load_trace(TRACE);
+	if (sharded) c->run_sharded(0, 3);
+	else c->run();
+	string printed = dump(c);
+	delete c;
+	return printed;
+}
+
+int main(int argc, char **argv){
+
+	//one set of 32 ways: blocks 0 to 31 fill it, 0 is read again, 32 evicts 1 (the least recently
+	//used), 1 evicts 2 and 0 still hits
+	FILE *f = fopen(TRACE, "w");
+	for (unsigned b=0; b<32; b++) fprintf(f, "r 0x%x\n", b * 64);
+	fputs("r 0x0\nr 0x800\nr 0x40\nr 0x0\n", f);
+	fclose(f);
+	for (unsigned simd=0; simd<2; simd++){
+		cache *mycache = new cache(2*KB, 32, 64, WRITE_BACK, WRITE_ALLOCATE, 2, 100, 32);
+		mycache->set_simd_kernels(simd);
+		mycache->load_trace(TRACE);
+		mycache->run();
+		cache_stats_t s = mycache->statistics();
+		cout << (simd ? "AVX2 allowed" : "scalar") << endl;
+		expect("  read misses", s.readMisses, 34);
+		expect("  evictions", s.evictions, 2);
+		expect("  block 2 gone", mycache->read(0x80) == MISS, 1);
+		delete mycache;
+	}
+	cout << endl;
+
+	//8, 16 and 32 ways with all four write policy pairs, run serially and sharded
+	write_trace(50000, 64*KB);
+	unsigned ways[] = {8, 16, 32};
+	write_policy_t hit[] = {WRITE_BACK, WRITE_THROUGH, WRITE_BACK, WRITE_THROUGH};
+	write_policy_t miss[] = {WRITE_ALLOCATE, NO_WRITE_ALLOCATE, NO_WRITE_ALLOCATE, WRITE_ALLOCATE};
+	for (unsigned w=0; w<3; w++){
+		for (unsigned p=0; p<4; p++){
+			cout << dec << ways[w] << "-way " << (hit[p] == WRITE_BACK ? "WB" : "WT") << "/" << (miss[p] == WRITE_ALLOCATE ? "WA" : "NWA") << endl;
+			string scalar = replay(ways[w], hit[p], miss[p], false, false);
+			expect("  AVX2 matches scalar", replay(ways[w], hit[p], miss[p], true, false) == scalar, 1);
+			expect("  AVX2 sharded matches scalar", replay(ways[w], hit[p], miss[p], true, true) == scalar, 1);
+		}
+	}
+
+	remove(TRACE);
+	return failed_checks != 0;
+}
@@ -0,0 +1,75 @@
+#include "cache.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: replacement policies on direct-mapped, non-power-of-two and very wide sets */
+
+//fixed pseudo-random accesses over "footprint" bytes
+static void run_accesses(cache *c, unsigned count, unsigned footprint){
+	access_gen gen;
+	for (unsigned i=0; i<count; i++){
+		gen.next();
+		c->access(gen.offset(footprint), gen.op());
+	}
+}
+
+//reads the blocks of "blocks" (64-byte lines) in order and returns the statistics
+static cache_stats_t read_blocks(unsigned size, unsigned ways, replacement_policy_t policy, const char *blocks){
+	cache c(size, ways, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32, policy);
+	for (const char *b = blocks; *b; b++) c.access((*b - 'A') * 64, 'r');
+	return c.statistics();
+}
+
+int main(int argc, char **argv){
+
+	//one set of two ways, blocks A B A C B: LRU evicts B for C and then A for B,
+	//FIFO evicts A (the oldest fill) for C and then hits on B
+	cache_stats_t s = read_blocks(128, 2, REPLACE_LRU, "ABACB");
+	expect("LRU misses", s.readMisses, 4);
+	expect("LRU evictions", s.evictions, 2);
+	s = read_blocks(128, 2, REPLACE_FIFO, "ABACB");
+	expect("FIFO misses", s.readMisses, 3);
+	expect("FIFO evictions", s.evictions, 1);
+
+	//direct-mapped with two sets, blocks A B A C A: A and C share set 0 and throw each other out
+	s = read_blocks(128, 1, REPLACE_LRU, "ABACA");
+	expect("direct-mapped misses", s.readMisses, 4);
+	expect("direct-mapped evictions", s.evictions, 2);
+	cout << endl;
+
+	replacement_policy_t policies[] = {REPLACE_LRU, REPLACE_FIFO, REPLACE_RANDOM, REPLACE_TREE_PLRU, REPLACE_NRU,
+	                                   REPLACE_SRRIP, REPLACE_BRRIP, REPLACE_DRRIP, REPLACE_LFU};
+	unsigned ways[] = {1, 3, 128};
+
+	for (unsigned w=0; w<3; w++){
+		for (unsigned p=0; p<9; p++){
+
+			cache *mycache = new cache(ways[w]*4*KB,	//size
+					  ways[w],		//associativity
+					  64,			//cache line size
+					  WRITE_BACK,		//write hit policy
+					  WRITE_ALLOCATE,	//write miss policy
+					  5,			//hit time
+					  100,			//miss penalty
+					  32,			//address width
+					  policies[p]		//replacement policy
+					  );
+
+			cout << "REQUESTED POLICY = " << replacement_policy_name(policies[p]) << endl;
+			mycache->print_configuration();
+			run_accesses(mycache, 20000, ways[w]*8*KB);
+			cout << endl;
+			mycache->print_statistics();
+			cout << endl;
+
+			delete mycache;
+		}
+	}
+	return failed_checks != 0;
+}
@@ -0,0 +1,154 @@
+#include "cache.h"
+#include "access_gen.h"
+#include "le_bytes.h"
+#include <iostream>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: checkpoint round trip, and checkpoints the cache or trace cannot take */
+
+#define TRACE_FILE "testcase7.t"
+#define CHECKPOINT_FILE "testcase7.ckpt"
+
+//writes "count" fixed pseudo-random accesses over "footprint" bytes
+static void write_trace(const char *filename, unsigned count, unsigned footprint){
+	FILE *f = fopen(filename, "w");
+	access_gen gen;
+	for (unsigned i=0; i<count; i++){
+		gen.next();
+		fprintf(f, "%c 0x%x\n", gen.op(), unsigned(gen.offset(footprint)));
+	}
+	fclose(f);
+}
+
+//reads a whole file into "bytes"
+static void read_file(const char *filename, vector<unsigned char> &bytes){
+	bytes.clear();
+	FILE *f = fopen(filename, "rb");
+	int c;
+	while ((c = fgetc(f)) != EOF) bytes.push_back((unsigned char)c);
+	fclose(f);
+}
+
+static cache *make_cache(unsigned ways, replacement_policy_t policy, unsigned sectors, assist_cache_t assist){
+	cache *c = new cache(16*KB,		//size
+			  ways,			//associativity
+			  64,			//cache line size
+			  WRITE_BACK,		//write hit policy
+			  WRITE_ALLOCATE,	//write miss policy
+			  5,			//hit time
+			  100,			//miss penalty
+			  32,			//address width
+			  policy		//replacement policy
+			  );
+	if (sectors > 1) c->set_sectors(sectors);
+	c->set_victim_cache(8, assist);
+	c->load_trace(TRACE_FILE);
+	return c;
+}
+
+int main(int argc, char **argv){
+
+	replacement_policy_t policies[] = {REPLACE_LRU, REPLACE_SRRIP};
+	unsigned sectors[] = {1, 4};
+
+	//one set of two lines after a read of block 1 and a write of block 2: an 80-byte header, 11 counters,
+	//two tags, two state bytes padded to 8 and two LRU stamps, every value little-endian
+	FILE *f = fopen(TRACE_FILE, "w");
+	fputs("r 0x40\nw 0x80\n", f);
+	fclose(f);
+	cache *mycache = new cache(128, 2, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	mycache->load_trace(TRACE_FILE);
+	mycache->run();
+	expect("save", mycache->save_checkpoint(CHECKPOINT_FILE), 1);
+	vector<unsigned char> bytes;
+	read_file(CHECKPOINT_FILE, bytes);
+	expect("snapshot size", bytes.size(), 80 + 88 + 16 + 8 + 16);
+	if (bytes.size() == 208){
+		expect("reads", get_le(&bytes[80], 8), 1);
+		expect("writes", get_le(&bytes[96], 8), 1);
+		expect("tag of line 0", get_le(&bytes[168], 8), 1);
+		expect("tag of line 1", get_le(&bytes[176], 8), 2);
+		expect("line 1 dirty", (bytes[185] & LINE_DIRTY) != 0, 1);
+		expect("LRU stamp of line 1 is later", get_le(&bytes[200], 8) > get_le(&bytes[192], 8), 1);
+	}
+	delete mycache;
+
+	//state the snapshot does not hold makes the save fail rather than vanish on a load
+	mycache = new cache(16*KB, 4, 64, WRITE_BACK, WRITE_ALLOCATE, 5, 100, 32);
+	mycache->set_prefetcher(PREFETCH_NEXT_LINE);
+	expect("save with a prefetcher", mycache->save_checkpoint(CHECKPOINT_FILE), 0);
+	mycache->set_prefetcher(PREFETCH_NONE);
+	mycache->set_mshrs(4);
+	expect("save with MSHRs", mycache->save_checkpoint(CHECKPOINT_FILE), 0);
+	mycache->set_mshrs(0);
+	mycache->set_interval_sampling(1000, 100, 0);
+	expect("save while sampling", mycache->save_checkpoint(CHECKPOINT_FILE), 0);
+	mycache->set_interval_sampling(0, 0, 0);
+	mycache->set_miss_classification();
+	expect("save while classifying misses", mycache->save_checkpoint(CHECKPOINT_FILE), 0);
+	mycache->set_miss_classification(false);
+	expect("save with all of them off", mycache->save_checkpoint(CHECKPOINT_FILE), 1);
+	delete mycache;
+	cout << endl;
+
+	write_trace(TRACE_FILE, 60000, 64*KB);
+
+	for (unsigned p=0; p<2; p++){
+
+		cout << "POLICY = " << replacement_policy_name(policies[p]) << ", SECTORS = " << sectors[p] << endl;
+		cout << "===================" << endl << endl;
+
+		//the full run, checkpointed after the warm-up
+		mycache = make_cache(4, policies[p], sectors[p], VICTIM_CACHE);
+		mycache->run(20000);
+		cout << "save = " << mycache->save_checkpoint(CHECKPOINT_FILE) << endl;
+		mycache->run();
+		mycache->print_statistics();
+		cout << endl;
+		delete mycache;
+
+		//resumed with the warm-up counted: same statistics as the full run
+		mycache = make_cache(4, policies[p], sectors[p], VICTIM_CACHE);
+		cout << "load with statistics = " << mycache->load_checkpoint(CHECKPOINT_FILE, true) << endl;
+		mycache->run();
+		mycache->print_statistics();
+		cout << endl;
+		delete mycache;
+
+		//resumed after accesses of its own, which are left out along with the warm-up
+		mycache = make_cache(4, policies[p], sectors[p], VICTIM_CACHE);
+		mycache->run(100);
+		cout << "load without statistics = " << mycache->load_checkpoint(CHECKPOINT_FILE) << endl;
+		mycache->run();
+		mycache->print_statistics();
+		cout << endl;
+		delete mycache;
+
+		//snapshots of another configuration are rejected
+		mycache = make_cache(2, policies[p], sectors[p], VICTIM_CACHE);
+		cout << "load into a 2-way cache = " << mycache->load_checkpoint(CHECKPOINT_FILE) << endl;
+		delete mycache;
+
+		mycache = make_cache(4, policies[p], sectors[p], MISS_CACHE);
+		cout << "load into a cache with a miss cache = " << mycache->load_checkpoint(CHECKPOINT_FILE) << endl;
+		delete mycache;
+
+		//as are snapshots past the end of the loaded trace
+		write_trace(TRACE_FILE, 1000, 64*KB);
+		mycache = make_cache(4, policies[p], sectors[p], VICTIM_CACHE);
+		cout << "load with a shorter trace = " << mycache->load_checkpoint(CHECKPOINT_FILE) << endl;
+		delete mycache;
+		write_trace(TRACE_FILE, 60000, 64*KB);
+		cout << endl;
+	}
+
+	remove(TRACE_FILE);
+	remove(CHECKPOINT_FILE);
+	return failed_checks != 0;
+}
@@ -0,0 +1,100 @@
+#include "coherence.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: coherence protocols over a snooping bus and a directory */
+
+//fixed pseudo-random accesses of every core, half of them to a small shared region
+static void run_accesses(coherent_system *s, unsigned cores, unsigned count){
+	access_gen gen;
+	for (unsigned i=0; i<count; i++){
+		gen.next();
+		unsigned core = gen.bits(20) % cores;
+		address_t address = gen.offset(16*KB);
+		if (gen.bits(61) & 1) address += 0x100000 * (core + 1);	//private data
+		s->access(core, gen.op(), address);
+	}
+}
+
+static void check_core(coherent_system *s, unsigned core, const core_stats_t &e){
+	core_stats_t c = s->core_statistics(core);
+	cout << "core " << core << endl;
+	expect("  reads", c.reads, e.reads);
+	expect("  writes", c.writes, e.writes);
+	expect("  misses", c.misses, e.misses);
+	expect("  coherence misses", c.coherenceMisses, e.coherenceMisses);
+	expect("  upgrades", c.upgrades, e.upgrades);
+	expect("  invalidations", c.invalidations, e.invalidations);
+	expect("  interventions", c.interventions, e.interventions);
+	expect("  writebacks", c.writebacks, e.writebacks);
+	expect("  latency", c.latency, e.latency);
+}
+
+int main(int argc, char **argv){
+
+	//two MESI cores behind a directory passing one block back and forth
+	//(hit time 2, memory latency 100, cache-to-cache latency 20):
+	//  core 0 reads    from memory, E                                  102
+	//  core 1 reads    from memory, core 0 drops to S, both S          102
+	//  core 0 writes   upgrade, invalidates core 1, M                   22
+	//  core 1 reads    coherence miss, core 0 supplies and writes back  22
+	//  core 1 writes   upgrade, invalidates core 0, M                   22
+	coherent_system *system = new coherent_system(2, 8*KB, 4, 64, 2, 100, 20, 32, MESI, DIRECTORY);
+	expect("latency", system->access(0, 'r', 0x40), 102);
+	expect("latency", system->access(1, 'r', 0x40), 102);
+	expect("latency", system->access(0, 'w', 0x40), 22);
+	expect("latency", system->access(1, 'r', 0x40), 22);
+	expect("latency", system->access(1, 'w', 0x40), 22);
+	core_stats_t first = {1, 1, 1, 0, 1, 1, 1, 1, 124};
+	core_stats_t second = {2, 1, 2, 1, 1, 1, 0, 0, 146};
+	check_core(system, 0, first);
+	check_core(system, 1, second);
+	//only core 1 holds the block now
+	expect("directory entries", system->directory_entries(), 1);
+	//a core the system does not have has done nothing
+	expect("reads of core 7", system->core_statistics(7).reads, 0);
+	cout << endl;
+	delete system;
+
+	coherence_protocol_t protocols[] = {MSI, MESI, MOESI};
+	interconnect_t interconnects[] = {SNOOPING_BUS, DIRECTORY};
+
+	for (unsigned p=0; p<3; p++){
+		for (unsigned n=0; n<2; n++){
+
+			coherent_system *system = new coherent_system(4,	//cores
+					  8*KB,			//private cache size
+					  4,			//associativity
+					  64,			//cache line size
+					  2,			//hit time
+					  100,			//memory latency
+					  20,			//cache-to-cache latency
+					  32,			//address width
+					  protocols[p],		//coherence protocol
+					  interconnects[n]	//interconnect
+					  );
+
+			system->print_configuration();
+			run_accesses(system, 4, 40000);
+			cout << endl;
+			system->print_statistics();
+			cout << endl;
+
+			delete system;
+		}
+	}
+
+	//sharer masks cannot hold more cores than MAX_CORES
+	system = new coherent_system(100, 8*KB, 4, 64, 2, 100, 20, 32, MESI, DIRECTORY);
+	system->print_configuration();
+	run_accesses(system, 100, 40000);
+	cout << endl << "accesses of core 63 = " << system->core_statistics(63).reads + system->core_statistics(63).writes << endl;
+	delete system;
+	return failed_checks != 0;
+}
@@ -0,0 +1,88 @@
+#include "hierarchy.h"
+#include "access_gen.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+#define KB 1024
+
+using namespace std;
+
+/* Test case for cache simulator: two-level hierarchies under every inclusion policy */
+
+//fixed pseudo-random accesses, three quarters of them to a hot region
+static void run_accesses(cache_hierarchy *h, unsigned count){
+	access_gen gen;
+	for (unsigned i=0; i<count; i++){
+		gen.next();
+		h->access(gen.op(), gen.offset((gen.bits(60) & 3) ? 6*KB : 1024*KB));
+	}
+}
+
+//reads blocks A B A C and then "last" through two one-set, two-way levels (hit times 2 and 10,
+//memory 100) and checks the latency of each read; the L1 keeps A as most recently used, so C
+//replaces B there while replacing A in the L2
+static void check_policy(inclusion_policy_t policy, const char *last, const unsigned *latencies,
+                         unsigned l1Misses, unsigned l2Misses, unsigned long long l1Invalidated, unsigned long long l2In){
+	cache_hierarchy h(policy, 100);
+	h.add_level(new cache(128, 2, 64, WRITE_BACK, WRITE_ALLOCATE, 2, 100, 32));
+	h.add_level(new cache(128, 2, 64, WRITE_BACK, WRITE_ALLOCATE, 10, 100, 32));
+	const char *blocks = "ABAC";
+	for (unsigned i=0; i<5; i++){
+		char block = (i < 4) ? blocks[i] : *last;
+		expect("  latency", h.access('r', (block - 'A') * 64), latencies[i]);
+	}
+	expect("  L1 misses", h.level_statistics(0).misses, l1Misses);
+	expect("  L2 misses", h.level_statistics(1).misses, l2Misses);
+	expect("  L1 back-invalidations", h.level_statistics(0).backInvalidations, l1Invalidated);
+	expect("  blocks into the L2", h.level_statistics(1).blocksIn, l2In);
+}
+
+int main(int argc, char **argv){
+
+	//inclusive: the L2 throwing A out takes it out of the L1, so the last read of A misses everywhere
+	cout << "inclusive, A last" << endl;
+	unsigned inclusive[] = {112, 112, 2, 112, 112};
+	check_policy(INCLUSIVE, "A", inclusive, 4, 4, 1, 0);
+	//non-inclusive: the L1 keeps A
+	cout << "non-inclusive, A last" << endl;
+	unsigned nonInclusive[] = {112, 112, 2, 112, 2};
+	check_policy(NON_INCLUSIVE, "A", nonInclusive, 3, 3, 0, 0);
+	//exclusive: B moves down to the L2 when C replaces it, and comes back up from there
+	//(pushing A down in turn)
+	cout << "exclusive, B last" << endl;
+	unsigned exclusive[] = {112, 112, 2, 112, 12};
+	check_policy(EXCLUSIVE, "B", exclusive, 4, 3, 0, 2);
+	cout << endl;
+
+	inclusion_policy_t policies[] = {INCLUSIVE, EXCLUSIVE, NON_INCLUSIVE, NON_INCLUSIVE};
+	const char *names[] = {"INCLUSIVE", "EXCLUSIVE", "NON-INCLUSIVE", "NON-INCLUSIVE, WRITE-THROUGH L1"};
+
+	for (unsigned p=0; p<4; p++){
+
+		cout << "INCLUSION = " << names[p] << endl;
+		cout << "===================" << endl << endl;
+
+		bool through = (p == 3);
+		cache_hierarchy *hierarchy = new cache_hierarchy(policies[p], 100);
+		hierarchy->add_level(new cache(8*KB,		//size
+				  2,			//associativity
+				  64,			//cache line size
+				  through ? WRITE_THROUGH : WRITE_BACK,		//write hit policy
+				  through ? NO_WRITE_ALLOCATE : WRITE_ALLOCATE,	//write miss policy
+				  2,			//hit time
+				  100,			//miss penalty
+				  32			//address width
+				  ));
+		hierarchy->add_level(new cache(64*KB, 8, 64, WRITE_BACK, WRITE_ALLOCATE, 10, 100, 32));
+
+		hierarchy->print_configuration();
+		run_accesses(hierarchy, 50000);
+		cout << endl;
+		hierarchy->print_statistics();
+		cout << endl;
+
+		delete hierarchy;
+	}
+	return failed_checks != 0;
+}
@@ -0,0 +1,167 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#include "tlb.h"
+#include <iostream>
+
+using namespace std;
+
+#define PAGE_BITS_FIELD 6   //low bits of a translation key holding the page bits
+
+tlb::tlb(unsigned num_entries, unsigned associativity, unsigned hit_time){
+    if(associativity == 0 || associativity > num_entries) associativity = num_entries;
+    entries = num_entries;
+    numWays = associativity;
+    numSets = num_entries / associativity;
+    hitTime = hit_time;
+    keys.assign(num_entries, 0);
+    frames.assign(num_entries, 0);
+    stamps.assign(num_entries, 0);
+    clock = 0;
+    accesses = 0;
+    misses = 0;
+}
+
+bool tlb::lookup(long long key, long long &frame, bool counted){
+    unsigned base = unsigned((key >> PAGE_BITS_FIELD) & (numSets - 1)) * numWays;
+    if(counted) accesses++;
+    for(unsigned i = base; i < base + numWays; i++){
+        if(stamps[i] && keys[i] == key){
+            stamps[i] = ++clock;
+            frame = frames[i];
+            return true;
+        }
+    }
+    if(counted) misses++;
+    return false;
+}
+
+void tlb::insert(long long key, long long frame){
+    unsigned base = unsigned((key >> PAGE_BITS_FIELD) & (numSets - 1)) * numWays;
+    unsigned victim = base;
+    for(unsigned i = base; i < base + numWays; i++){
+        if(stamps[i] < stamps[victim]) victim = i;
+    }
+    keys[victim] = key;
+    frames[victim] = frame;
+    stamps[victim] = ++clock;
+}
+
+tlb_hierarchy::tlb_hierarchy(unsigned walk_latency, unsigned page_size){
+    walkLatency = walk_latency;
+    defaultPageBits = 0;
+    while((1u << defaultPageBits) < page_size) defaultPageBits++;
+    nextFrame = 0;
+    numWalks = 0;
+    walkCycles = 0;
+    pagesMapped.assign(64, 0);
+}
+
+tlb_hierarchy::~tlb_hierarchy(){
+    for(unsigned i = 0; i < levels.size(); i++) delete levels[i];
+}
+
+void tlb_hierarchy::add_level(unsigned entries, unsigned associativity, unsigned hit_time){
+    levels.push_back(new tlb(entries, associativity, hit_time));
+}
+
+void tlb_hierarchy::map_huge_pages(long long start, unsigned long long bytes, unsigned long long page_size){
+    huge_page_region_t r;
+    r.pageBits = 0;
+    while((1ULL << r.pageBits) < page_size) r.pageBits++;
+    long long size = 1LL << r.pageBits;
+    r.start = start & ~(size - 1);
+    r.end = (start + (long long)bytes + size - 1) & ~(size - 1);
+    regions.push_back(r);
+}
+
+unsigned tlb_hierarchy::min_page_bits() const{
+    unsigned bits = defaultPageBits;
+    for(unsigned i = 0; i < regions.size(); i++){
+        if(regions[i].pageBits < bits) bits = regions[i].pageBits;
+    }
+    return bits;
+}
+
+unsigned tlb_hierarchy::page_bits(long long address) const{
+    for(unsigned i = 0; i < regions.size(); i++){
+        if(address >= regions[i].start && address < regions[i].end) return regions[i].pageBits;
+    }
+    return defaultPageBits;
+}
+
+long long tlb_hierarchy::translate(long long address, unsigned &latency, bool counted){
+    unsigned bits = page_bits(address);
+    long long offset = address & ((1LL << bits) - 1);
+    long long key = ((address >> bits) << PAGE_BITS_FIELD) | bits;
+    long long frame = 0;
+
+    unsigned level = 0;
+    for(; level < levels.size(); level++){
+        latency += levels[level]->hitTime;
+        if(levels[level]->lookup(key, frame, counted)) break;
+    }
+    if(level == levels.size()){
+        //walk the radix page table, mapping the page on its first touch
+        unsigned depth = (VIRTUAL_ADDRESS_BITS - bits + PAGE_TABLE_INDEX_BITS - 1) / PAGE_TABLE_INDEX_BITS;
+        if(counted){
+            numWalks++;
+            walkCycles += depth * walkLatency;
+        }
+        latency += depth * walkLatency;
+
+        unordered_map<long long, long long>::iterator it = pageTable.find(key);
+        if(it == pageTable.end()){
+            long long size = 1LL << bits;
+            nextFrame = (nextFrame + size - 1) & ~(size - 1);
+            it = pageTable.insert(make_pair(key, nextFrame)).first;
+            nextFrame += size;
+            pagesMapped[bits]++;
+        }
+        frame = it->second;
+    }
+    for(unsigned i = 0; i < level && i < levels.size(); i++) levels[i]->insert(key, frame);
+    return frame | offset;
+}
+
+//page size in readable units
+static void print_page_size(unsigned bits){
+    if(bits >= 30) cout << (1ULL << (bits - 30)) << " GB";
+    else if(bits >= 20) cout << (1ULL << (bits - 20)) << " MB";
+    else if(bits >= 10) cout << (1ULL << (bits - 10)) << " KB";
+    else cout << (1ULL << bits) << " B";
+}
+
+void tlb_hierarchy::print_configuration() const{
+    for(unsigned i = 0; i < levels.size(); i++){
+        const tlb *t = levels[i];
+        cout << "L" << i + 1 << " TLB = " << dec << t->entries << " entries, " << t->numWays << "-way, " << t->hitTime << " CLK" << endl;
+    }
+    cout << "page walk = " << dec << walkLatency << " CLK per page table level" << endl;
+    cout << "page size = ";
+    print_page_size(defaultPageBits);
+    cout << endl;
+    for(unsigned i = 0; i < regions.size(); i++){
+        cout << "huge pages = ";
+        print_page_size(regions[i].pageBits);
+        cout << " over 0x" << hex << regions[i].start << "-0x" << regions[i].end << dec << endl;
+    }
+}
+
+void tlb_hierarchy::print_statistics() const{
+    for(unsigned i = 0; i < levels.size(); i++){
+        const tlb *t = levels[i];
+        cout << "L" << i + 1 << " TLB accesses = " << dec << t->accesses << endl;
+        cout << "L" << i + 1 << " TLB misses = " << dec << t->misses << endl;
+        cout << "L" << i + 1 << " TLB miss rate = " << (t->accesses ? double(t->misses) / double(t->accesses) : 0.0) << endl;
+    }
+    cout << "page walks = " << dec << numWalks << " (" << walkCycles << " CLK)" << endl;
+    for(unsigned bits = 0; bits < pagesMapped.size(); bits++){
+        if(!pagesMapped[bits]) continue;
+        cout << "pages mapped (";
+        print_page_size(bits);
+        cout << ") = " << dec << pagesMapped[bits] << endl;
+    }
+}
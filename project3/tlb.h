@@ -0,0 +1,111 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#ifndef TLB_H_
+#define TLB_H_
+
+#include <vector>
+#include <unordered_map>
+
+#define VIRTUAL_ADDRESS_BITS 48     //translated by a radix page table
+#define PAGE_TABLE_INDEX_BITS 9     //virtual page number bits resolved by each page table level
+
+//a virtual address range mapped with pages larger than the default page
+typedef struct{
+    long long start;
+    long long end;                  // first byte past the range
+    unsigned pageBits;              // log2 of the page size
+} huge_page_region_t;
+
+//One set-associative LRU TLB. Translations of every page size share it: an
+//entry is keyed by the virtual page number and the page size, and the set is
+//taken from the low bits of the virtual page number (entries / associativity
+//must be a power of two).
+class tlb{
+    unsigned numSets;
+    unsigned numWays;
+    std::vector<long long> keys;                // (virtual page number << 6) | page bits
+    std::vector<long long> frames;              // physical address of the page
+    std::vector<unsigned long long> stamps;     // LRU timestamp, 0 for an empty entry
+    unsigned long long clock;
+
+public:
+    unsigned entries;
+    unsigned hitTime;                           // clock cycles
+    unsigned long long accesses;
+    unsigned long long misses;
+
+    tlb(unsigned num_entries, unsigned associativity, unsigned hit_time);
+
+    // looks up "key"; on a hit stores the page's physical address in "frame"
+    // ("counted" false leaves the access and miss counts alone)
+    bool lookup(long long key, long long &frame, bool counted=true);
+
+    // brings a translation in, replacing the least recently used entry of its set
+    void insert(long long key, long long frame);
+
+    friend class tlb_hierarchy;
+};
+
+//TLB levels (L1 first) in front of a page table. A translation that misses a
+//level looks in the next one and is copied into every level it missed on; a
+//miss in the last level walks the page table, one memory access per level of
+//the radix tree, so 4 KB pages take 4 accesses, 2 MB pages 3 and 1 GB pages 2.
+//
+//Pages get physical frames on first touch, in order and aligned to their size,
+//from physical address 0; every access therefore has a fixed physical address
+//for the whole run, and the physical footprint of huge pages shows up as the
+//alignment gaps between them.
+class tlb_hierarchy{
+    std::vector<tlb *> levels;
+    unsigned defaultPageBits;
+    std::vector<huge_page_region_t> regions;
+    unsigned walkLatency;                                   // clock cycles per page table level
+    std::unordered_map<long long, long long> pageTable;     // key -> physical address of the page
+    long long nextFrame;                                    // first free physical address
+
+    unsigned long long numWalks;
+    unsigned long long walkCycles;
+    std::vector<unsigned long long> pagesMapped;            // per page bits
+
+    tlb_hierarchy(const tlb_hierarchy &);
+    tlb_hierarchy &operator=(const tlb_hierarchy &);
+
+    // log2 of the size of the page holding "address"
+    unsigned page_bits(long long address) const;
+
+public:
+    tlb_hierarchy(unsigned walk_latency,            // clock cycles per page table level read in a walk
+                  unsigned page_size=4096           // default page size (in bytes, a power of two)
+    );
+
+    // deletes the levels
+    ~tlb_hierarchy();
+
+    // appends a TLB of "entries" entries below the current last one
+    void add_level(unsigned entries, unsigned associativity, unsigned hit_time);
+
+    // maps [start, start+bytes) with pages of "page_size" bytes (e.g. 2 MB or 1 GB) instead of the
+    // default; the range is widened to whole pages, and the first region holding an address wins
+    void map_huge_pages(long long start, unsigned long long bytes, unsigned long long page_size);
+
+    // smallest page size in use, in log2 bytes: virtual and physical addresses agree below it
+    unsigned min_page_bits() const;
+
+    // hit time of the first level (0 without levels)
+    unsigned first_hit_time() const { return levels.empty() ? 0 : levels[0]->hitTime; }
+
+    // translates a virtual address, adding the cycles spent in the TLBs and the walk to "latency";
+    // with "counted" false the TLBs and page table are only warmed, and no access or walk is counted
+    long long translate(long long address, unsigned &latency, bool counted=true);
+
+    // prints the TLB levels, page sizes and walk cost
+    void print_configuration() const;
+
+    // prints per-level TLB statistics, page walks and mapped pages
+    void print_statistics() const;
+};
+
+#endif /*TLB_H_*/
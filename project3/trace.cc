@@ -0,0 +1,140 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#include "trace.h"
+#include "le_bytes.h"
+#include <stdio.h>
+#include <string.h>
+
+trace_reader::trace_reader(){
+    data = first = cur = end = NULL;
+    binary = false;
+    lastAddress = 0;
+    lastError = NULL;
+}
+
+trace_reader::~trace_reader(){
+    close();
+}
+
+bool trace_reader::open(const char *filename, trace_format_t format){
+    close();
+
+    if(!file.open(filename, true)){
+        lastError = "cannot open the file";
+        return false;
+    }
+    data = cur = file.begin();
+    end = data + file.size();
+
+    //a text trace that happens to start with the magic is told apart by the version,
+    //whose high bytes are 0 in any binary trace
+    const unsigned char *header = (const unsigned char *)cur;
+    bool magic = (end - cur >= 8 && memcmp(cur, TRACE_MAGIC, 4) == 0);
+    unsigned long long version = magic ? get_le(header + 4, 4) : 0;
+    binary = magic && version == TRACE_VERSION;
+    if(!binary && magic && (format == TRACE_BINARY || version < 0x100)){
+        close();
+        lastError = "unsupported binary trace version";
+        return false;
+    }
+    if(format == TRACE_BINARY && !binary){
+        close();
+        lastError = "not a binary trace";
+        return false;
+    }
+    if(format == TRACE_TEXT && binary){
+        close();
+        lastError = "binary trace opened as text";
+        return false;
+    }
+    if(binary){
+        //an entry cut off by the end of the file is caught by next()
+        if(end - cur < TRACE_HEADER_SIZE || (unsigned long long)(end - cur - TRACE_HEADER_SIZE) != get_le(header + 16, 8)){
+            close();
+            lastError = "binary trace is truncated or its length does not match the header";
+            return false;
+        }
+        cur += TRACE_HEADER_SIZE;
+    }
+    first = cur;
+    return true;
+}
+
+void trace_reader::share(const trace_reader &source){
+    close();
+    data = source.data;
+    first = cur = source.first;
+    end = source.end;
+    binary = source.binary;
+}
+
+bool trace_reader::seek(unsigned long long offset, unsigned long long last_address){
+    if(data == NULL || offset < (unsigned long long)(first - data) || offset > (unsigned long long)(end - data))
+        return false;
+    cur = data + offset;
+    lastAddress = last_address;
+    return true;
+}
+
+void trace_reader::close(){
+    file.close();
+    data = first = cur = end = NULL;
+    binary = false;
+    lastAddress = 0;
+    lastError = NULL;
+}
+
+long long convert_trace(const char *text_file, const char *binary_file, unsigned long long *dropped){
+    trace_reader in;
+    if(!in.open(text_file, TRACE_TEXT)) return -1;
+    FILE *out = fopen(binary_file, "wb");
+    if(out == NULL) return -1;
+
+    //the entry count and length are patched in once the whole trace has been written
+    unsigned char header[TRACE_HEADER_SIZE];
+    memcpy(header, TRACE_MAGIC, 4);
+    put_le(header + 4, TRACE_VERSION, 4);
+    put_le(header + 8, 0, 16);
+    fwrite(header, 1, TRACE_HEADER_SIZE, out);
+
+    unsigned long long entries = 0;
+    unsigned long long length = 0;
+    unsigned long long skipped = 0;
+    unsigned long long last = 0;
+    unsigned char entry[10];
+    char op;
+    long long address;
+    while(in.next(op, address)){
+        if(op != 'r' && op != 'w'){
+            skipped++;
+            continue;
+        }
+
+        long long delta = (long long)((unsigned long long)address - last);
+        unsigned long long z = ((unsigned long long)delta << 1) ^ (unsigned long long)(delta >> 63);
+        last = (unsigned long long)address;
+
+        unsigned n = 0;
+        unsigned char b = (unsigned char)((op == 'w' ? 1 : 0) | ((z & 0x3F) << 1));
+        z >>= 6;
+        while(z != 0){
+            entry[n++] = b | 0x80;
+            b = (unsigned char)(z & 0x7F);
+            z >>= 7;
+        }
+        entry[n++] = b;
+        fwrite(entry, 1, n, out);
+        entries++;
+        length += n;
+    }
+
+    if(dropped != NULL) *dropped = skipped;
+    put_le(header + 8, entries, 8);
+    put_le(header + 16, length, 8);
+    bool ok = (fseek(out, 8, SEEK_SET) == 0 && fwrite(header + 8, 1, 16, out) == 16);
+    ok = (fclose(out) == 0) && ok;
+    return ok ? (long long)entries : -1;
+}
@@ -0,0 +1,198 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "mapped_file.h"
+#include <stddef.h>
+
+typedef enum {TRACE_AUTO, TRACE_TEXT, TRACE_BINARY} trace_format_t;
+
+//Binary traces start with a TRACE_HEADER_SIZE byte header: the magic
+//"CTRB", a little-endian 32-bit version, a 64-bit entry count and the
+//64-bit length in bytes of the entries that follow, which open() checks
+//against the file size to catch truncated traces without reading them.
+//Each entry is then a varint: bit 0 of the first byte is the op (1 = write),
+//bits 1-6 and the low 7 bits of any following bytes hold the zigzag-encoded
+//delta from the previous address, and bit 7 marks a continuation byte.
+#define TRACE_MAGIC "CTRB"
+#define TRACE_VERSION 2
+#define TRACE_HEADER_SIZE 24
+
+//Zero-copy reader for text traces of the form "r 0x7fff5a8487f0" and for
+//binary traces. The file is memory-mapped once and every call to next()
+//decodes the following entry in place, so parsing makes no allocations and
+//the position survives between calls (which is what cache::run(n) relies on).
+class trace_reader{
+    mapped_file file;       //the trace, unless it is shared with another reader
+    const char *data;       //start of the mapped (or buffered) trace
+    const char *first;      //first entry, past any header
+    const char *cur;        //next character to parse
+    const char *end;        //one past the last character
+    bool binary;            //entries are varint-encoded
+    unsigned long long lastAddress; //previous address of a binary trace
+    const char *lastError;  //why the last open() failed or the trace stopped early, NULL if neither
+
+    bool next_binary(char &op, long long &address);
+
+    // parses a hex number (with or without "0x") starting at "p"; returns where it ends
+    const char *parse_hex(const char *p, unsigned long long &value) const;
+
+    trace_reader(const trace_reader &);
+    trace_reader &operator=(const trace_reader &);
+
+public:
+    trace_reader();
+    ~trace_reader();
+
+    // maps the trace file; returns false if it cannot be opened, is not in "format", or is a binary
+    // trace of another version or whose length does not match its header (see error())
+    bool open(const char *filename, trace_format_t format=TRACE_AUTO);
+
+    // why the last open() failed, or why next() stopped before the end of a binary trace
+    // (an entry cut off by the end of the file), or NULL
+    const char *error() const { return lastError; }
+
+    // reads the trace already opened by "source" from its first entry, without
+    // copying or re-mapping it; "source" must stay open while this reader is used
+    void share(const trace_reader &source);
+
+    // releases the current trace, if any
+    void close();
+
+    // parses the next entry; returns false at the end of the trace
+    bool next(char &op, long long &address);
+
+    // position of the next entry and the address it is decoded against, for checkpoints
+    unsigned long long tell() const { return (unsigned long long)(cur - data); }
+    unsigned long long last_address() const { return lastAddress; }
+
+    // resumes at a position returned by tell(); returns false if no trace is open or it lies outside it
+    bool seek(unsigned long long offset, unsigned long long last_address);
+
+    // parses the next entry of a text trace annotated with a PC and a data-structure tag
+    // ("r 0x7fff5a8487f0 0x4005d2 0x3"); fields missing from the line, or from a binary trace, are 0
+    bool next(char &op, long long &address, long long &pc, long long &tag);
+
+    // parses the next entry of a multi-core text trace ("2 r 0x7fff5a8487f0", core ID first);
+    // binary traces carry no core ID, so their entries all belong to core 0
+    bool next(unsigned &core, char &op, long long &address);
+};
+
+// converts a text trace into the binary format; returns the number of
+// entries written, or -1 on an I/O error; entries other than r/w cannot be
+// encoded, so they are dropped and counted in "dropped" (when not NULL)
+long long convert_trace(const char *text_file, const char *binary_file, unsigned long long *dropped=NULL);
+
+inline bool trace_reader::next(char &op, long long &address){
+    if(binary) return next_binary(op, address);
+
+    const char *p = cur;
+
+    //skip blank lines and leading whitespace
+    while(p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    if(p == end){
+        cur = p;
+        return false;
+    }
+    op = *p++;
+
+    while(p < end && (*p == ' ' || *p == '\t')) p++;
+    unsigned long long value;
+    p = parse_hex(p, value);
+    address = (long long)value;
+
+    //ignore anything else on the line
+    while(p < end && *p != '\n') p++;
+    cur = p;
+    return true;
+}
+
+inline const char *trace_reader::parse_hex(const char *p, unsigned long long &value) const{
+    if(p + 1 < end && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) p += 2;
+
+    value = 0;
+    while(p < end){
+        unsigned digit = unsigned(*p) - '0';
+        if(digit > 9){
+            digit = (unsigned(*p) | 0x20) - 'a';
+            if(digit > 5) break;
+            digit += 10;
+        }
+        value = (value << 4) | digit;
+        p++;
+    }
+    return p;
+}
+
+inline bool trace_reader::next(char &op, long long &address, long long &pc, long long &tag){
+    pc = 0;
+    tag = 0;
+    if(binary) return next_binary(op, address);
+
+    const char *p = cur;
+    while(p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    if(p == end){
+        cur = p;
+        return false;
+    }
+    op = *p++;
+
+    unsigned long long value[3] = {0, 0, 0};
+    for(unsigned field = 0; field < 3; field++){
+        while(p < end && (*p == ' ' || *p == '\t')) p++;
+        if(p == end || *p == '\n' || *p == '\r') break;
+        p = parse_hex(p, value[field]);
+    }
+    address = (long long)value[0];
+    pc = (long long)value[1];
+    tag = (long long)value[2];
+
+    while(p < end && *p != '\n') p++;
+    cur = p;
+    return true;
+}
+
+inline bool trace_reader::next(unsigned &core, char &op, long long &address){
+    core = 0;
+    if(binary) return next_binary(op, address);
+
+    const char *p = cur;
+    while(p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    while(p < end && unsigned(*p - '0') <= 9){
+        core = core * 10 + unsigned(*p - '0');
+        p++;
+    }
+    cur = p;
+    return next(op, address);
+}
+
+inline bool trace_reader::next_binary(char &op, long long &address){
+    const unsigned char *p = (const unsigned char *)cur;
+    const unsigned char *stop = (const unsigned char *)end;
+    if(p == stop) return false;
+
+    unsigned char b = *p++;
+    op = (b & 1) ? 'w' : 'r';
+    unsigned long long z = (b >> 1) & 0x3F;
+    unsigned shift = 6;
+    while(b & 0x80){
+        if(p == stop){
+            lastError = "binary trace ends inside an entry";
+            cur = end;
+            return false;
+        }
+        b = *p++;
+        if(shift < 64) z |= (unsigned long long)(b & 0x7F) << shift;
+        shift += 7;
+    }
+    lastAddress += (z >> 1) ^ (0 - (z & 1));
+    address = (long long)lastAddress;
+    cur = (const char *)p;
+    return true;
+}
+
+#endif /*TRACE_H_*/
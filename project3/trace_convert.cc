@@ -0,0 +1,30 @@
+//-------------------------------------
+//      ECE 463 Project 3
+//          Alan Zheng
+//      NCSU Spring 2021
+//-------------------------------------
+#include "trace.h"
+#include <iostream>
+
+using namespace std;
+
+/* Converts a text trace ("r 0x...") into the binary trace format */
+
+int main(int argc, char **argv){
+	if(argc != 3){
+		cerr << "usage: " << argv[0] << " <text trace> <binary trace>" << endl;
+		return 1;
+	}
+	unsigned long long dropped = 0;
+	long long entries = convert_trace(argv[1], argv[2], &dropped);
+	if(entries < 0){
+		cerr << "cannot convert " << argv[1] << " to " << argv[2] << endl;
+		return 1;
+	}
+	cout << "converted " << entries << " accesses" << endl;
+	if(dropped != 0){
+		cerr << "dropped " << dropped << " entries other than r/w: runs of the binary trace count "
+		     << dropped << " fewer memory accesses than the text trace" << endl;
+	}
+	return 0;
+}